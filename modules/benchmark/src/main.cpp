@@ -0,0 +1,773 @@
+/*
+ * main.cpp
+ *
+ *  Created on: 18.10.2026
+ *
+ * Benchmarks for the camera calibration library. Every benchmark is a subcommand which works on a
+ * directory or a tar/zip archive of calibration images, a calibration video, rendered boards or a
+ * directory of camera files.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <camera_calibration/BatchedFileReader.h>
+#include <camera_calibration/CameraCalibration.h>
+#include <camera_calibration/CameraModel.h>
+#include <camera_calibration/ImageArchive.h>
+#include <camera_calibration/SaddlePointDetector.h>
+#include <camera_calibration/utils.h>
+#include <chrono>
+#include <cstdlib>
+#include <fcntl.h>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <new>
+#include <regex>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace
+{
+/**
+ * Number of calls of the global operator new, see the replacement below.
+ */
+std::atomic<size_t> heapAllocations(0);
+
+/**
+ * Number of allocated cv::Mat buffers. They are allocated with cv::fastMalloc() and not counted
+ * by operator new.
+ */
+std::atomic<size_t> matAllocations(0);
+
+/**
+ * Counts the buffers of cv::Mat and forwards them to the standard allocator of OpenCV, which also
+ * frees them.
+ */
+class CountingMatAllocator : public cv::MatAllocator
+{
+public:
+    cv::UMatData* allocate(int dims, const int* sizes, int type, void* data, size_t* step,
+        cv::AccessFlag flags, cv::UMatUsageFlags usageFlags) const override
+    {
+        if (!data)
+            ++matAllocations;
+        return cv::Mat::getStdAllocator()->allocate(
+            dims, sizes, type, data, step, flags, usageFlags);
+    }
+
+    bool allocate(cv::UMatData* data, cv::AccessFlag accessFlags,
+        cv::UMatUsageFlags usageFlags) const override
+    {
+        return cv::Mat::getStdAllocator()->allocate(data, accessFlags, usageFlags);
+    }
+
+    void deallocate(cv::UMatData* data) const override
+    {
+        cv::Mat::getStdAllocator()->deallocate(data);
+    }
+};
+
+/**
+ * The first images of a calibration fill the reused buffers and are not counted.
+ */
+constexpr size_t warmUpImages = 2;
+
+struct BenchSettings
+{
+    std::string inputPath;
+    cv::Size2i chessboardSize = cv::Size2i(7, 6);
+};
+//-------------------------------------------------------------------------------------------------
+std::vector<std::string> readImageFiles(const std::string& dirPath)
+{
+    // the images of an archive are read from the mapped archive
+    if (libba::ImageArchive::isArchive(dirPath))
+        return libba::ImageArchive::open(dirPath)->getMemberPaths({ ".png", ".jpg", ".jpeg" });
+
+    const std::regex filter(".*\\.(jpg|jpeg|png)", std::regex::icase);
+    std::vector<std::string> files = libba::readFilesFromDir(dirPath, filter);
+    std::sort(files.begin(), files.end());
+    return files;
+}
+//-------------------------------------------------------------------------------------------------
+double millisecondsSince(const std::chrono::steady_clock::time_point& startTime)
+{
+    const std::chrono::duration<double, std::milli> elapsed
+        = std::chrono::steady_clock::now() - startTime;
+    return elapsed.count();
+}
+//-------------------------------------------------------------------------------------------------
+/**
+ * Starts calibrations which are stopped after increasing delays and measures the time between the
+ * stop request and the end of the calibration thread. The worst case over all delays is the stop
+ * latency which a user can experience. The calibrations run once with the default solver, which
+ * finishes its run after a stop request, and once with the interruptible solver of the GUI.
+ */
+int benchStopLatency(const BenchSettings& settings)
+{
+    const std::vector<std::string> files = readImageFiles(settings.inputPath);
+    if (files.empty())
+    {
+        std::cerr << "No images found in " << settings.inputPath << std::endl;
+        return 1;
+    }
+
+    const std::vector<int> delays = { 0, 10, 50, 100, 250, 500, 1000, 2000, 5000, 10000 };
+
+    std::cout << "solver\tdelay [ms]\tlatency [ms]\tinternal latency [ms]" << std::endl;
+    for (const bool interruptible : { false, true })
+    {
+        const std::string solverName = interruptible ? "interruptible" : "default";
+        double worstLatency = 0;
+        for (const int delay : delays)
+        {
+            libba::CameraCalibration calibTool;
+            calibTool.setChessboardSize(settings.chessboardSize);
+            calibTool.setFiles(files);
+            calibTool.setInterruptibleSolver(interruptible);
+
+            std::atomic<bool> finished(false);
+            std::thread worker([&calibTool, &finished]() {
+                try
+                {
+                    calibTool.calibrateCamera([](int, int, std::string) {});
+                }
+                catch (const std::exception& e)
+                {
+                    std::cerr << e.what() << std::endl;
+                }
+                finished = true;
+            });
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(delay));
+            const bool finishedBeforeStop = finished;
+            const auto stopTime = std::chrono::steady_clock::now();
+            calibTool.stopCalibration();
+            worker.join();
+            const double latency = millisecondsSince(stopTime);
+
+            if (finishedBeforeStop)
+            {
+                std::cout << solverName << "\t" << delay
+                          << "\tcalibration finished before the stop request" << std::endl;
+                break;
+            }
+
+            worstLatency = std::max(worstLatency, latency);
+            std::cout << solverName << "\t" << delay << "\t" << latency << "\t"
+                      << calibTool.getStopLatency() << std::endl;
+        }
+
+        std::cout << "worst stop latency of the " << solverName << " solver [ms]: " << worstLatency
+                  << std::endl;
+    }
+    return 0;
+}
+//-------------------------------------------------------------------------------------------------
+/**
+ * Calibrates with all frames of a video, once with a pattern detection on every frame and once
+ * with corner tracking, and compares the processed frames per second.
+ */
+int benchVideoTracking(const BenchSettings& settings)
+{
+    std::cout << "mode\tframes\tfound\ttracked\tframes/s\treprojection error" << std::endl;
+    for (const bool tracking : { false, true })
+    {
+        libba::CameraCalibration calibTool;
+        calibTool.setChessboardSize(settings.chessboardSize);
+        calibTool.setCornerTracking(tracking);
+
+        const auto startTime = std::chrono::steady_clock::now();
+        try
+        {
+            calibTool.calibrateCameraFromVideo(settings.inputPath,
+                libba::CameraCalibration::VideoSampling(), [](int, int, std::string) {});
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+        const double seconds = millisecondsSince(startTime) / 1000.0;
+
+        const std::vector<libba::CameraCalibration::CalibImgInfo> images
+            = calibTool.getCalibInfo();
+        const auto found = std::count_if(images.begin(), images.end(),
+            [](const libba::CameraCalibration::CalibImgInfo& info) { return info.patternFound; });
+        const auto tracked = std::count_if(images.begin(), images.end(),
+            [](const libba::CameraCalibration::CalibImgInfo& info) {
+                return info.patternFound && info.cornersTracked;
+            });
+
+        std::cout << (tracking ? "tracking" : "detection") << "\t" << images.size() << "\t"
+                  << found << "\t" << tracked << "\t" << images.size() / seconds << "\t"
+                  << calibTool.getReprojectionError() << std::endl;
+    }
+    return 0;
+}
+//-------------------------------------------------------------------------------------------------
+/**
+ * Detects the pattern on all images with the default strategy, the whole detection ladder and
+ * the ladder with an adaptive start and compares the total detection time.
+ */
+int benchDetectionLadder(const BenchSettings& settings)
+{
+    using Strategy = libba::CameraCalibration::DetectionStrategy;
+    const std::vector<std::string> files = readImageFiles(settings.inputPath);
+    if (files.empty())
+    {
+        std::cerr << "No images found in " << settings.inputPath << std::endl;
+        return 1;
+    }
+
+    const std::vector<Strategy> ladder = { Strategy::DownscaledFastCheck, Strategy::Default,
+        Strategy::AdaptiveNormalize, Strategy::SectorBased };
+    struct LadderConfig
+    {
+        std::string name;
+        std::vector<Strategy> strategies;
+        bool adaptiveStart;
+    };
+    const std::vector<LadderConfig> configs = { { "default", { Strategy::Default }, false },
+        { "ladder", ladder, false }, { "adaptive", ladder, true } };
+
+    std::cout << "ladder\tfound\tdetection time [ms]\tfound per strategy" << std::endl;
+    for (const LadderConfig& config : configs)
+    {
+        libba::CameraCalibration calibTool;
+        calibTool.setChessboardSize(settings.chessboardSize);
+        calibTool.setFiles(files);
+        calibTool.setDetectionLadder(config.strategies, config.adaptiveStart);
+
+        std::vector<libba::CameraCalibration::CalibImgInfo> images(files.size());
+        try
+        {
+            calibTool.calibrateCamera([](int, int, std::string) {},
+                [&images](size_t idx, const libba::CameraCalibration::CalibImgInfo& info) {
+                    images[idx] = info;
+                });
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+
+        double detectionTime = 0;
+        size_t found = 0;
+        std::vector<size_t> foundPerStrategy(ladder.size(), 0);
+        for (const auto& info : images)
+        {
+            detectionTime += info.detectionTime;
+            if (!info.patternFound)
+                continue;
+            found++;
+            foundPerStrategy[static_cast<size_t>(info.detectionStrategy)]++;
+        }
+
+        std::cout << config.name << "\t" << found << "\t" << detectionTime << "\t";
+        for (const size_t count : foundPerStrategy)
+            std::cout << count << " ";
+        std::cout << std::endl;
+    }
+    return 0;
+}
+//-------------------------------------------------------------------------------------------------
+/**
+ * Calibrates with every detection backend on the same images and compares the time per image
+ * and the reprojection error.
+ */
+int benchBackends(const BenchSettings& settings)
+{
+    using Backend = libba::CameraCalibration::DetectionBackend;
+    const std::vector<std::string> files = readImageFiles(settings.inputPath);
+    if (files.empty())
+    {
+        std::cerr << "No images found in " << settings.inputPath << std::endl;
+        return 1;
+    }
+
+    const std::vector<std::pair<std::string, Backend> > backends
+        = { { "classic+cornerSubPix", Backend::ClassicCornerSubPix },
+              { "classic+find4Quad", Backend::ClassicFind4Quad },
+              { "SB", Backend::SectorBased }, { "SB+accuracy", Backend::SectorBasedAccuracy },
+              { "saddle+cornerSubPix", Backend::SaddlePoint } };
+
+    std::cout << "backend\tfound\ttime per image [ms]\treprojection error" << std::endl;
+    for (const auto& [name, backend] : backends)
+    {
+        libba::CameraCalibration calibTool;
+        calibTool.setChessboardSize(settings.chessboardSize);
+        calibTool.setFiles(files);
+        calibTool.setDetectionBackend(backend);
+
+        std::vector<libba::CameraCalibration::CalibImgInfo> images(files.size());
+        try
+        {
+            calibTool.calibrateCamera([](int, int, std::string) {},
+                [&images](size_t idx, const libba::CameraCalibration::CalibImgInfo& info) {
+                    images[idx] = info;
+                });
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << name << ": " << e.what() << std::endl;
+            continue;
+        }
+
+        double detectionTime = 0;
+        size_t found = 0;
+        for (const auto& info : images)
+        {
+            detectionTime += info.detectionTime;
+            found += info.patternFound ? 1 : 0;
+        }
+
+        std::cout << name << "\t" << found << "\t" << detectionTime / images.size() << "\t"
+                  << calibTool.getReprojectionError() << std::endl;
+    }
+    return 0;
+}
+//-------------------------------------------------------------------------------------------------
+/**
+ * Renders a chessboard with a random perspective, blur and noise and returns the ground truth
+ * positions of its inner corners.
+ */
+cv::Mat renderSyntheticBoard(
+    const cv::Size2i& patternSize, cv::RNG& rng, std::vector<cv::Point2f>& groundTruth)
+{
+    constexpr int squareSize = 40;
+    constexpr int margin = squareSize;
+    const cv::Size2i imageSize(1280, 960);
+
+    const cv::Size2i boardSize((patternSize.width + 1) * squareSize + 2 * margin,
+        (patternSize.height + 1) * squareSize + 2 * margin);
+    cv::Mat board(boardSize, CV_8UC1, cv::Scalar(230));
+    for (int row = 0; row <= patternSize.height; ++row)
+        for (int col = 0; col <= patternSize.width; ++col)
+            if ((row + col) % 2 == 0)
+                board(cv::Rect(margin + col * squareSize, margin + row * squareSize, squareSize,
+                          squareSize))
+                    .setTo(cv::Scalar(25));
+
+    // the board covers about half of the image and every corner is moved randomly
+    const float scale = 0.6f
+        * std::min(static_cast<float>(imageSize.width) / boardSize.width,
+            static_cast<float>(imageSize.height) / boardSize.height);
+    const cv::Point2f center(imageSize.width / 2.f, imageSize.height / 2.f);
+    const std::vector<cv::Point2f> src = { cv::Point2f(0, 0), cv::Point2f(boardSize.width, 0),
+        cv::Point2f(boardSize.width, boardSize.height), cv::Point2f(0, boardSize.height) };
+    std::vector<cv::Point2f> dst;
+    for (const cv::Point2f& p : src)
+    {
+        const cv::Point2f jitter(rng.uniform(-0.15f, 0.15f) * boardSize.width * scale,
+            rng.uniform(-0.15f, 0.15f) * boardSize.height * scale);
+        dst.push_back(center + (p - cv::Point2f(boardSize.width / 2.f, boardSize.height / 2.f))
+                * scale
+            + jitter);
+    }
+    const cv::Mat homography = cv::getPerspectiveTransform(src, dst);
+
+    cv::Mat img;
+    cv::warpPerspective(board, img, homography, imageSize, cv::INTER_LINEAR,
+        cv::BORDER_CONSTANT, cv::Scalar(128));
+    cv::GaussianBlur(img, img, cv::Size(0, 0), 1.0);
+    cv::Mat noise(img.size(), CV_16SC1);
+    rng.fill(noise, cv::RNG::NORMAL, 0, 5);
+    img.convertTo(img, CV_16SC1);
+    img += noise;
+    img.convertTo(img, CV_8UC1);
+
+    // a corner between the pixels k - 1 and k of the board lies at k - 0.5 in pixel coordinates
+    std::vector<cv::Point2f> boardCorners;
+    for (int row = 1; row <= patternSize.height; ++row)
+        for (int col = 1; col <= patternSize.width; ++col)
+            boardCorners.emplace_back(
+                margin + col * squareSize - 0.5f, margin + row * squareSize - 0.5f);
+    cv::perspectiveTransform(boardCorners, groundTruth, homography);
+    return img;
+}
+//-------------------------------------------------------------------------------------------------
+/**
+ * Detects the corners on synthetic boards with cv::findChessboardCorners(), the sector based
+ * detector and the saddle point detector and compares the time, the detection rate and the mean
+ * distance of the corners to the ground truth. The corners are matched to the nearest ground truth
+ * corner, so the error does not depend on the order of the corners.
+ */
+int benchSynthetic(const BenchSettings& settings)
+{
+    const int imageCount = std::stoi(settings.inputPath);
+    const cv::Size2i patternSize = settings.chessboardSize;
+    const cv::TermCriteria criteria(cv::TermCriteria::EPS + cv::TermCriteria::COUNT, 30, 0.01);
+
+    using Detector = std::function<bool(const cv::Mat&, std::vector<cv::Point2f>&)>;
+    const std::vector<std::pair<std::string, Detector> > detectors
+        = { { "classic+cornerSubPix",
+                [&](const cv::Mat& img, std::vector<cv::Point2f>& corners) {
+                    if (!cv::findChessboardCorners(img, patternSize, corners,
+                            cv::CALIB_CB_ADAPTIVE_THRESH | cv::CALIB_CB_FILTER_QUADS))
+                        return false;
+                    cv::cornerSubPix(img, corners, cv::Size(5, 5), cv::Size(-1, -1), criteria);
+                    return true;
+                } },
+              { "SB",
+                  [&](const cv::Mat& img, std::vector<cv::Point2f>& corners) {
+                      return cv::findChessboardCornersSB(
+                          img, patternSize, corners, cv::CALIB_CB_NORMALIZE_IMAGE);
+                  } },
+              { "saddle+cornerSubPix",
+                  [&](const cv::Mat& img, std::vector<cv::Point2f>& corners) {
+                      if (!libba::findChessboardCornersSaddle(img, patternSize, corners))
+                          return false;
+                      cv::cornerSubPix(
+                          img, corners, cv::Size(5, 5), cv::Size(-1, -1), criteria);
+                      return true;
+                  } } };
+
+    // every detector gets the same images
+    cv::RNG rng(42);
+    std::vector<cv::Mat> images;
+    std::vector<std::vector<cv::Point2f> > groundTruths(imageCount);
+    for (int i = 0; i < imageCount; ++i)
+        images.push_back(renderSyntheticBoard(patternSize, rng, groundTruths[i]));
+
+    std::cout << "detector\tfound\ttime per image [ms]\tmean corner error [px]" << std::endl;
+    for (const auto& [name, detector] : detectors)
+    {
+        size_t found = 0;
+        double detectionTime = 0;
+        double errorSum = 0;
+        size_t errorCount = 0;
+        for (int i = 0; i < imageCount; ++i)
+        {
+            std::vector<cv::Point2f> corners;
+            const auto startTime = std::chrono::steady_clock::now();
+            const bool patternFound = detector(images[i], corners);
+            detectionTime += millisecondsSince(startTime);
+            if (!patternFound)
+                continue;
+
+            found++;
+            for (const cv::Point2f& corner : corners)
+            {
+                double minDistance = std::numeric_limits<double>::max();
+                for (const cv::Point2f& truth : groundTruths[i])
+                    minDistance = std::min(minDistance, cv::norm(corner - truth));
+                errorSum += minDistance;
+                errorCount++;
+            }
+        }
+
+        std::cout << name << "\t" << found << "/" << imageCount << "\t"
+                  << detectionTime / imageCount << "\t"
+                  << (errorCount > 0 ? errorSum / errorCount : 0) << std::endl;
+    }
+    return 0;
+}
+//-------------------------------------------------------------------------------------------------
+/**
+ * Counts the heap allocations and the cv::Mat buffers per image of the detection loop after the
+ * warm-up. The loop runs once with the image filters only, all images are rejected as blurred,
+ * and once with the pattern detection. The remaining allocations of the first run come from the
+ * image decoders, those of the second run additionally from the OpenCV detectors.
+ */
+int benchAllocations(const BenchSettings& settings)
+{
+    const std::vector<std::string> files = readImageFiles(settings.inputPath);
+    if (files.size() <= warmUpImages)
+    {
+        std::cerr << "At least " << warmUpImages + 1 << " images are needed in "
+                  << settings.inputPath << std::endl;
+        return 1;
+    }
+
+    static CountingMatAllocator matAllocator;
+    cv::Mat::setDefaultAllocator(&matAllocator);
+
+    std::cout << "loop\tnew/image\tmax new/image\tMat buffers/image\tmax Mat buffers/image"
+              << std::endl;
+    for (const bool detection : { false, true })
+    {
+        libba::CameraCalibration calibTool;
+        calibTool.setChessboardSize(settings.chessboardSize);
+        calibTool.setFiles(files);
+        if (!detection)
+            calibTool.setQualityThresholds(std::numeric_limits<float>::max(), 1);
+
+        // the counters are read when the result of an image is reported for the first time
+        std::vector<size_t> heapCounts(files.size(), 0);
+        std::vector<size_t> matCounts(files.size(), 0);
+        std::vector<bool> counted(files.size(), false);
+        try
+        {
+            calibTool.calibrateCamera([](int, int, std::string) {},
+                [&](size_t idx, const libba::CameraCalibration::CalibImgInfo&) {
+                    if (counted[idx])
+                        return;
+                    heapCounts[idx] = heapAllocations;
+                    matCounts[idx] = matAllocations;
+                    counted[idx] = true;
+                });
+        }
+        catch (const std::exception& e)
+        {
+            // without found patterns the solver fails, the loop was still measured
+            if (detection)
+                std::cerr << e.what() << std::endl;
+        }
+
+        size_t heapTotal = 0, heapMax = 0, matTotal = 0, matMax = 0;
+        const size_t countedImages = files.size() - warmUpImages;
+        for (size_t i = warmUpImages; i < files.size(); ++i)
+        {
+            const size_t heap = heapCounts[i] - heapCounts[i - 1];
+            const size_t mats = matCounts[i] - matCounts[i - 1];
+            heapTotal += heap;
+            heapMax = std::max(heapMax, heap);
+            matTotal += mats;
+            matMax = std::max(matMax, mats);
+        }
+
+        std::cout << (detection ? "detection" : "filters only") << "\t"
+                  << double(heapTotal) / countedImages << "\t" << heapMax << "\t"
+                  << double(matTotal) / countedImages << "\t" << matMax << std::endl;
+    }
+
+    cv::Mat::setDefaultAllocator(nullptr);
+    return 0;
+}
+//-------------------------------------------------------------------------------------------------
+/**
+ * Asks the kernel to drop the files from the page cache, so that the next reads go to the disk.
+ * Only pages without pending writes are dropped and only on systems with posix_fadvise().
+ */
+void evictFromPageCache(const std::vector<std::string>& files)
+{
+#ifdef POSIX_FADV_DONTNEED
+    for (const auto& file : files)
+    {
+        const int fd = ::open(file.c_str(), O_RDONLY);
+        if (fd < 0)
+            continue;
+        ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        ::close(fd);
+    }
+#else
+    (void)files;
+#endif
+}
+//-------------------------------------------------------------------------------------------------
+/**
+ * Reads and decodes all images once synchronously, once with the thread pool of the
+ * BatchedFileReader and once with io_uring. The files are evicted from the page cache before
+ * every run. The wait share is the part of the time in which the decoding waited for the disk.
+ */
+int benchFileReading(const BenchSettings& settings)
+{
+    const std::vector<std::string> files = readImageFiles(settings.inputPath);
+    if (files.empty())
+    {
+        std::cerr << "No images found in " << settings.inputPath << std::endl;
+        return 1;
+    }
+
+    struct ReaderConfig
+    {
+        std::string name;
+        size_t readAhead;
+        bool useIoUring;
+    };
+    const std::vector<ReaderConfig> configs = { { "synchronous", 0, false },
+        { "thread pool", 16, false }, { "io_uring", 16, true } };
+
+    std::cout << "reader\tMB\tMB/s\twait [%]\timages/s" << std::endl;
+    for (const auto& config : configs)
+    {
+        if (config.useIoUring && !libba::BatchedFileReader::isIoUringSupported())
+        {
+            std::cout << config.name << "\tnot available, built without liburing" << std::endl;
+            continue;
+        }
+
+        evictFromPageCache(files);
+        std::vector<uchar> data;
+        cv::Mat image;
+        size_t bytes = 0;
+        double waitMs = 0;
+        std::string name = config.name;
+        const auto startTime = std::chrono::steady_clock::now();
+        if (config.readAhead == 0)
+        {
+            for (const auto& file : files)
+            {
+                const auto readStart = std::chrono::steady_clock::now();
+                if (libba::readFileInto(file, data))
+                    bytes += data.size();
+                waitMs += millisecondsSince(readStart);
+                cv::imdecode(data, cv::IMREAD_GRAYSCALE, &image);
+            }
+        }
+        else
+        {
+            libba::BatchedFileReader::Options options;
+            options.readAhead = config.readAhead;
+            options.useIoUring = config.useIoUring;
+            libba::BatchedFileReader reader(files, options);
+            if (config.useIoUring && !reader.usesIoUring())
+                name += " (not available, thread pool)";
+            while (reader.hasNext())
+                if (reader.readNext(data))
+                    cv::imdecode(data, cv::IMREAD_GRAYSCALE, &image);
+
+            const libba::BatchedFileReader::Statistics statistics = reader.getStatistics();
+            bytes = statistics.bytes;
+            waitMs = statistics.waitSeconds * 1000;
+        }
+        const double totalMs = millisecondsSince(startTime);
+
+        std::cout << name << "\t" << bytes / 1e6 << "\t" << bytes / (1e3 * totalMs) << "\t"
+                  << 100 * waitMs / totalMs << "\t" << 1000 * files.size() / totalMs << std::endl;
+    }
+    return 0;
+}
+//-------------------------------------------------------------------------------------------------
+/**
+ * Loads all camera files of a directory once with a CameraCalibration per file, once
+ * sequentially as CameraModel and once in parallel with loadCameraModels().
+ */
+int benchModelLoading(const BenchSettings& settings)
+{
+    const std::regex filter(".*\\.(xml|json|bcal)");
+    std::vector<std::string> files = libba::readFilesFromDir(settings.inputPath, filter);
+    std::sort(files.begin(), files.end());
+    if (files.empty())
+    {
+        std::cerr << "No camera files found in " << settings.inputPath << std::endl;
+        return 1;
+    }
+
+    std::cout << "loader\tfiles\tfailed\tfiles/s" << std::endl;
+    auto printRun = [&files](const std::string& name, const size_t numFailed,
+                        const std::chrono::steady_clock::time_point& startTime) {
+        const double totalMs = millisecondsSince(startTime);
+        std::cout << name << "\t" << files.size() << "\t" << numFailed << "\t"
+                  << 1000 * files.size() / totalMs << std::endl;
+    };
+
+    size_t numFailed = 0;
+    auto startTime = std::chrono::steady_clock::now();
+    for (const auto& file : files)
+    {
+        try
+        {
+            libba::CameraCalibration calibTool;
+            calibTool.loadCameraParameters(file);
+        }
+        catch (const std::exception&)
+        {
+            ++numFailed;
+        }
+    }
+    printRun("CameraCalibration", numFailed, startTime);
+
+    numFailed = 0;
+    startTime = std::chrono::steady_clock::now();
+    for (const auto& file : files)
+    {
+        try
+        {
+            libba::loadCameraModel(file);
+        }
+        catch (const std::runtime_error&)
+        {
+            ++numFailed;
+        }
+    }
+    printRun("sequential", numFailed, startTime);
+
+    startTime = std::chrono::steady_clock::now();
+    const libba::CameraModelSet modelSet = libba::loadCameraModels(files);
+    printRun("parallel", modelSet.numFailed, startTime);
+    return 0;
+}
+//-------------------------------------------------------------------------------------------------
+void printUsage()
+{
+    std::cout << "Usage: calibBench <benchmark> "
+                 "<image directory or archive, video or number of images> "
+                 "[corners horizontal] [corners vertical]"
+              << std::endl
+              << "Benchmarks:" << std::endl
+              << "  stop-latency      time between a stop request and the end of the calibration"
+              << std::endl
+              << "  video-tracking    frames per second with and without corner tracking"
+              << std::endl
+              << "  detection-ladder  detection time of the default strategy and the ladder"
+              << std::endl
+              << "  backends          time per image and reprojection error of every backend"
+              << std::endl
+              << "  synthetic         detection rate and corner error on rendered boards"
+              << std::endl
+              << "  allocations       heap allocations per image of the detection loop"
+              << std::endl
+              << "  io                read throughput with and without reading ahead" << std::endl
+              << "  models            camera files per second of the loaders" << std::endl;
+}
+} // namespace
+
+// the replaced operator new counts all allocations of the process, also those of OpenCV
+void* operator new(std::size_t size)
+{
+    ++heapAllocations;
+    if (void* ptr = std::malloc(size > 0 ? size : 1))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 3)
+    {
+        printUsage();
+        return 1;
+    }
+
+    const std::string benchmark = argv[1];
+    BenchSettings settings;
+    settings.inputPath = argv[2];
+    if (argc >= 5)
+        settings.chessboardSize = cv::Size2i(std::stoi(argv[3]), std::stoi(argv[4]));
+
+    if (benchmark == "stop-latency")
+        return benchStopLatency(settings);
+    if (benchmark == "video-tracking")
+        return benchVideoTracking(settings);
+    if (benchmark == "detection-ladder")
+        return benchDetectionLadder(settings);
+    if (benchmark == "backends")
+        return benchBackends(settings);
+    if (benchmark == "synthetic")
+        return benchSynthetic(settings);
+    if (benchmark == "allocations")
+        return benchAllocations(settings);
+    if (benchmark == "io")
+        return benchFileReading(settings);
+    if (benchmark == "models")
+        return benchModelLoading(settings);
+
+    printUsage();
+    return 1;
+}
@@ -0,0 +1,116 @@
+/*
+ * BatchedFileReader.h
+ *
+ *  Created on: 18.10.2026
+ */
+
+#ifndef BATCHEDFILEREADER_H_
+#define BATCHEDFILEREADER_H_
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace libba
+{
+/**
+ * Reads a list of files ahead of their use, so that slow disks and network file systems do not
+ * block the decoding. The reads of the upcoming files are submitted in batches with io_uring if
+ * the library was built with liburing and the kernel allows it, otherwise they are read by a
+ * small thread pool. The kernel is asked to read the files after the read window ahead as well.
+ * The files are returned in the order of the list.
+ */
+class BatchedFileReader
+{
+public:
+    struct Options
+    {
+        /**
+         * Number of files which are read ahead of the consumer.
+         */
+        size_t readAhead = 8;
+
+        /**
+         * Number of threads of the thread pool, which is used without io_uring.
+         */
+        int numThreads = 4;
+
+        /**
+         * If set to false, the thread pool is used even if io_uring is available.
+         */
+        bool useIoUring = true;
+    };
+
+    struct Statistics
+    {
+        size_t files = 0;
+        size_t bytes = 0;
+
+        /**
+         * Time in seconds from the creation of the reader until the last file was returned.
+         */
+        double seconds = 0;
+
+        /**
+         * Time in seconds in which the consumer waited for files. If this is a large part of
+         * seconds, reading the files is the bottleneck.
+         */
+        double waitSeconds = 0;
+
+        double megabytesPerSecond() const;
+    };
+
+    explicit BatchedFileReader(const std::vector<std::string>& filePaths);
+    BatchedFileReader(const std::vector<std::string>& filePaths, const Options& options);
+    ~BatchedFileReader();
+
+    BatchedFileReader(const BatchedFileReader&) = delete;
+    BatchedFileReader& operator=(const BatchedFileReader&) = delete;
+
+    /**
+     * Waits until the next file is read and swaps its bytes into data. The previous memory of
+     * data is used to read a later file, so that the buffers are reused. Returns false if the
+     * file could not be read or all files were already returned.
+     */
+    bool readNext(std::vector<unsigned char>& data);
+
+    bool hasNext() const;
+
+    /**
+     * Returns true if the files are read with io_uring.
+     */
+    bool usesIoUring() const;
+
+    Statistics getStatistics() const;
+
+    /**
+     * Returns true if the library was built with liburing. io_uring can still be unavailable at
+     * runtime, e.g. if it is disabled by the kernel or a seccomp filter.
+     */
+    static bool isIoUringSupported();
+
+protected:
+    class Backend;
+    class ThreadPoolBackend;
+    class IoUringBackend;
+
+    /**
+     * The reads of the files are done by the backend.
+     */
+    std::unique_ptr<Backend> backend;
+
+    size_t numFiles;
+
+    /**
+     * Index of the file which is returned next.
+     */
+    size_t nextFile;
+
+    std::chrono::steady_clock::time_point startTime;
+    Statistics statistics;
+};
+
+} // namespace libba
+
+#endif /* BATCHEDFILEREADER_H_ */
@@ -0,0 +1,211 @@
+/*
+ * BcalFile.h
+ *
+ *  Created on: 18.10.2026
+ */
+
+#ifndef BCALFILE_H_
+#define BCALFILE_H_
+
+#include "camera_calibration/CameraCalibration.h"
+#include "camera_calibration/MappedFile.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace libba
+{
+/**
+ * The binary calibration result format (.bcal). The file contains the intrinsics, the distortion
+ * model and every view with its pose, observations and residuals, so that a calibration can be
+ * restored without detecting the patterns again.
+ *
+ * Layout, all values little endian:
+ *   BcalHeader
+ *   BcalView[numViews]      at viewsOffset, 8 byte aligned
+ *   BcalPoint[numPoints]    at pointsOffset, 4 byte aligned
+ *   char[stringsSize]       at stringsOffset, the file paths of the views
+ *
+ * The structs are the file layout, so a mapped file can be used directly through BcalFileView.
+ * Incompatible changes increase the version, fields which are added to the end of the header
+ * increase headerSize.
+ */
+constexpr char bcalMagic[8] = { 'B', 'C', 'A', 'L', '\r', '\n', 0x1A, '\n' };
+constexpr uint32_t bcalVersion = 1;
+
+/**
+ * Number of distortion coefficients in the header, the maximum of cv::calibrateCamera().
+ */
+constexpr size_t bcalMaxDistortionCoefficients = 14;
+
+struct BcalHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    uint64_t fileSize;
+
+    /**
+     * The camera matrix row by row.
+     */
+    double cameraMatrix[9];
+    double distortion[bcalMaxDistortionCoefficients];
+    uint32_t numDistortionCoefficients;
+
+    /**
+     * The flags of cv::calibrateCamera(), they define the distortion model.
+     */
+    uint32_t calibrationFlags;
+    int32_t imageWidth;
+    int32_t imageHeight;
+
+    /**
+     * CalibrationPattern::Type, its size and spacing. markerWidth and dictionaryId are only used
+     * by ChArUco boards.
+     */
+    int32_t patternType;
+    int32_t patternWidth;
+    int32_t patternHeight;
+    float patternSpacing;
+    float markerWidth;
+    int32_t dictionaryId;
+
+    float reprojectionError;
+    uint32_t numUsedImages;
+
+    uint64_t numViews;
+    uint64_t numPoints;
+    uint64_t viewsOffset;
+    uint64_t pointsOffset;
+    uint64_t stringsOffset;
+    uint64_t stringsSize;
+};
+
+/**
+ * Flags of a view.
+ */
+enum BcalViewFlags : uint32_t
+{
+    BcalPatternFound = 1 << 0,
+    BcalUsedForCalibration = 1 << 1,
+    BcalCornersTracked = 1 << 2,
+    BcalDetectedInRoi = 1 << 3,
+    BcalDetectionTimedOut = 1 << 4
+};
+
+/**
+ * A view, the binary form of CameraCalibration::CalibImgInfo.
+ */
+struct BcalView
+{
+    /**
+     * Rodrigues rotation vector and translation of the pattern.
+     */
+    double rotation[3];
+    double translation[3];
+
+    /**
+     * Index of the first observation of the view in the points.
+     */
+    uint64_t firstPoint;
+    uint64_t perceptualHash;
+
+    /**
+     * Position of the file path in the strings.
+     */
+    uint64_t pathOffset;
+    uint32_t pathLength;
+    uint32_t numPoints;
+    uint32_t flags;
+    int32_t frameIndex;
+    float reprojectionError;
+    float detectionTime;
+    float sharpness;
+    float clippedRatio;
+    uint16_t skipReason;
+    uint16_t detectionStrategy;
+    uint32_t reserved;
+};
+
+/**
+ * An observation of a pattern point. The residual is the reprojected point minus the observed
+ * point, it is zero for views without a pose.
+ */
+struct BcalPoint
+{
+    float x;
+    float y;
+    int32_t id;
+    float residualX;
+    float residualY;
+};
+
+static_assert(sizeof(BcalHeader) == 304, "The layout of BcalHeader is part of the file format.");
+static_assert(sizeof(BcalView) == 112, "The layout of BcalView is part of the file format.");
+static_assert(sizeof(BcalPoint) == 20, "The layout of BcalPoint is part of the file format.");
+
+/**
+ * Converts the information of an image into a view. The positions of its points and its file
+ * path (firstPoint, numPoints, pathOffset and pathLength) are not set.
+ */
+BcalView makeBcalView(const CameraCalibration::CalibImgInfo& info);
+
+/**
+ * Copies a view into the information of an image, except of its points and its file path.
+ */
+void readBcalView(const BcalView& view, CameraCalibration::CalibImgInfo& info);
+
+/**
+ * Computes the residuals of the points of a view, the reprojected points minus the observed
+ * points. Returns false and leaves residuals empty if the view has no pose.
+ */
+bool computeResiduals(const CameraCalibration::CalibrationResult& result,
+    const CameraCalibration::CalibImgInfo& info, std::vector<cv::Point2f>& residuals);
+
+/**
+ * Writes a calibration result as .bcal file. The residuals are computed from the poses of the
+ * views. The file is written to a temporary file which replaces filePath at the end, so readers
+ * never see a partial file. Throws a std::runtime_error if the file can not be written.
+ */
+void writeBcalFile(
+    const std::string& filePath, const CameraCalibration::CalibrationResult& result);
+
+/**
+ * A mapped .bcal file. The header, all offsets and the point ids are checked when the file is
+ * opened, the views and points are then used directly from the mapped file without parsing.
+ */
+class BcalFileView
+{
+public:
+    /**
+     * Throws a std::runtime_error if the file can not be mapped or is not a valid .bcal file.
+     */
+    explicit BcalFileView(const std::string& filePath);
+
+    const BcalHeader& getHeader() const;
+    size_t getNumViews() const;
+    const BcalView& getView(const size_t idx) const;
+
+    /**
+     * Returns the view.numPoints observations of the view.
+     */
+    const BcalPoint* getPoints(const BcalView& view) const;
+    std::string getFilePath(const BcalView& view) const;
+
+    /**
+     * Converts the file into a calibration result. The pattern is recreated from its type, a
+     * ChArUco board is replaced by a chessboard of the same size if ChArUco is not supported.
+     */
+    CameraCalibration::CalibrationResult toResult() const;
+
+protected:
+    MappedFile file;
+    const BcalHeader* header;
+    const BcalView* views;
+    const BcalPoint* points;
+    const char* strings;
+};
+
+} // namespace libba
+
+#endif /* BCALFILE_H_ */
@@ -0,0 +1,60 @@
+/*
+ * CalibrationJsonFile.h
+ *
+ *  Created on: 18.10.2026
+ */
+
+#ifndef CALIBRATIONJSONFILE_H_
+#define CALIBRATIONJSONFILE_H_
+
+#include "camera_calibration/CameraCalibration.h"
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace libba
+{
+/**
+ * JSON export of a calibration result with all views. The document has the keys of
+ * CameraCalibration::exportCameraParametersJSON(), so loadCameraParametersJSON() can read it,
+ * and additionally "calibration_flags", "num_used_images" and "views". Every view is an object
+ * with "file", "frame_index", "pattern_found", "used_for_calibration", "reprojection_error",
+ * "rotation" and "translation" (Rodrigues vector and translation of the pattern), "ids",
+ * "corners" ([x, y] per point) and "residuals" ([dx, dy] per point, the reprojected minus the
+ * observed point, empty for views without a pose). "views" is the last key and every view is
+ * written on its own line.
+ */
+
+/**
+ * JSON has no NaN or infinity, such reprojection errors of the result and of the views are
+ * written as null. readCalibrationJsonFile() returns this value for them.
+ */
+constexpr float jsonInvalidReprojectionError = -1;
+
+/**
+ * Called by readCalibrationJsonFile() for every view.
+ */
+using JsonViewFunc = std::function<void(const CameraCalibration::CalibImgInfo& view,
+    const std::vector<cv::Point2f>& residuals)>;
+
+/**
+ * Writes a calibration result with all views. The views are written one after the other with a
+ * JsonStreamWriter, so the memory does not grow with their number. The file is written to a
+ * temporary file which replaces filePath at the end. Throws a std::runtime_error if the file can
+ * not be written.
+ */
+void writeCalibrationJsonFile(
+    const std::string& filePath, const CameraCalibration::CalibrationResult& result);
+
+/**
+ * Reads a file of writeCalibrationJsonFile() and passes every view to viewFunc as soon as it was
+ * parsed. The view is dropped afterwards, so only one view is kept in memory at a time. Returns
+ * the intrinsics, the images of the result are empty. Throws a std::runtime_error if the file can
+ * not be read or is damaged.
+ */
+CameraCalibration::CalibrationResult readCalibrationJsonFile(
+    const std::string& filePath, const JsonViewFunc& viewFunc);
+
+} // namespace libba
+
+#endif /* CALIBRATIONJSONFILE_H_ */
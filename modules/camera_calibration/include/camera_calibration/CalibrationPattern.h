@@ -0,0 +1,236 @@
+/*
+ * CalibrationPattern.h
+ *
+ *  Created on: 18.10.2026
+ */
+
+#ifndef CALIBRATIONPATTERN_H_
+#define CALIBRATIONPATTERN_H_
+
+#include <memory>
+#include <opencv2/core.hpp>
+#include <vector>
+
+namespace libba
+{
+/**
+ * A planar calibration target. Every point of the pattern has an id, which is its index in
+ * getObjectPoints(). A detection returns the image positions of the found points and their ids,
+ * so the object points of every view can be looked up even if only a part of the pattern was
+ * visible.
+ */
+class CalibrationPattern
+{
+public:
+    enum class Type
+    {
+        Chessboard,
+        SymmetricCircleGrid,
+        AsymmetricCircleGrid,
+        ChArUco
+    };
+
+    virtual ~CalibrationPattern() = default;
+
+    virtual Type getType() const = 0;
+
+    /**
+     * Searches the pattern in a grayscale image.
+     * @param imagePoints The positions of the found points.
+     * @param pointIds The ids of the found points in the same order as imagePoints.
+     * @return True if enough points for a calibration view were found.
+     */
+    virtual bool detect(const cv::Mat& img, std::vector<cv::Point2f>& imagePoints,
+        std::vector<int>& pointIds) const = 0;
+
+    /**
+     * Returns true if the points are corners between black and white squares, which can be
+     * refined with cv::cornerSubPix().
+     */
+    virtual bool hasCorners() const = 0;
+
+    /**
+     * Returns true if a view can show only a part of the pattern.
+     */
+    virtual bool allowsPartialViews() const;
+
+    /**
+     * Returns a pattern of the same type with the given number of points per row and rows and the
+     * given spacing. All other properties of the pattern are kept.
+     */
+    virtual std::shared_ptr<const CalibrationPattern> withGeometry(
+        const cv::Size2i& newSize, const float newSpacing) const = 0;
+
+    /**
+     * The number of points per row and the number of rows of the pattern.
+     */
+    cv::Size2i getSize() const;
+
+    /**
+     * The distance between two neighboring rows of the pattern.
+     */
+    float getSpacing() const;
+
+    /**
+     * The positions of all points on the pattern plane z = 0, the index is the point id.
+     */
+    const std::vector<cv::Point3f>& getObjectPoints() const;
+
+    /**
+     * Writes the positions of the points with the given ids into points. The capacity of points
+     * is reused.
+     */
+    void getObjectPoints(const std::vector<int>& pointIds, std::vector<cv::Point3f>& points) const;
+
+    /**
+     * Draws the found points into a color image. A complete pattern is drawn as a connected grid
+     * like cv::drawChessboardCorners(), the points of a partial view are drawn with their ids.
+     */
+    void drawObservation(cv::Mat& img, const std::vector<cv::Point2f>& imagePoints,
+        const std::vector<int>& pointIds) const;
+
+protected:
+    CalibrationPattern(const cv::Size2i& size, const float spacing);
+
+    /**
+     * The number of points per row and the number of rows.
+     */
+    cv::Size2i size;
+
+    /**
+     * The distance between two neighboring rows.
+     */
+    float spacing;
+
+    /**
+     * The positions of the points, the index is the point id.
+     */
+    std::vector<cv::Point3f> objectPoints;
+};
+
+/**
+ * Chessboard with size.width x size.height inner corners and squares with the side length
+ * spacing. The corners are ordered row by row like the corners of cv::findChessboardCorners().
+ */
+class ChessboardPattern : public CalibrationPattern
+{
+public:
+    ChessboardPattern(const cv::Size2i& innerCorners, const float squareWidth);
+
+    Type getType() const override;
+
+    /**
+     * Searches the corners with cv::findChessboardCorners(). CameraCalibration uses its
+     * detection ladder and backends for chessboards instead.
+     */
+    bool detect(const cv::Mat& img, std::vector<cv::Point2f>& imagePoints,
+        std::vector<int>& pointIds) const override;
+
+    bool hasCorners() const override;
+
+    std::shared_ptr<const CalibrationPattern> withGeometry(
+        const cv::Size2i& newSize, const float newSpacing) const override;
+};
+
+/**
+ * Grid of dark circles which is found with cv::findCirclesGrid(). The circles of a symmetric
+ * grid are spacing apart in both directions. In an asymmetric grid every second row is shifted by
+ * spacing and the circles in a row are 2 * spacing apart.
+ */
+class CircleGridPattern : public CalibrationPattern
+{
+public:
+    CircleGridPattern(const cv::Size2i& circles, const float spacing, const bool asymmetric);
+
+    Type getType() const override;
+
+    bool detect(const cv::Mat& img, std::vector<cv::Point2f>& imagePoints,
+        std::vector<int>& pointIds) const override;
+
+    bool hasCorners() const override;
+
+    std::shared_ptr<const CalibrationPattern> withGeometry(
+        const cv::Size2i& newSize, const float newSpacing) const override;
+
+protected:
+    /**
+     * If set to true, every second row of the grid is shifted.
+     */
+    bool asymmetric;
+};
+
+/**
+ * Chessboard with ArUco markers in its white squares. The markers identify the corners, so
+ * views which show only a part of the board can be used. The points are the inner corners of the
+ * chessboard, ordered row by row. Only available if OpenCV was built with the ArUco module,
+ * otherwise the constructor throws.
+ */
+class CharucoPattern : public CalibrationPattern
+{
+public:
+    /**
+     * cv::aruco::DICT_6X6_250, the dictionary of the board generator of OpenCV.
+     */
+    static constexpr int defaultDictionaryId = 10;
+
+    /**
+     * cv::aruco::DICT_APRILTAG_36h11, the last predefined dictionary of all supported OpenCV
+     * versions.
+     */
+    static constexpr int maxDictionaryId = 20;
+
+    /**
+     * @param squares The number of squares per row and column.
+     * @param squareWidth The side length of the squares.
+     * @param markerWidth The side length of the markers.
+     * @param dictionaryId One of the predefined dictionaries cv::aruco::PredefinedDictionaryType.
+     */
+    CharucoPattern(const cv::Size2i& squares, const float squareWidth, const float markerWidth,
+        const int dictionaryId = defaultDictionaryId);
+
+    /**
+     * Returns true if the library was built with ChArUco support.
+     */
+    static bool isSupported();
+
+    Type getType() const override;
+
+    bool detect(const cv::Mat& img, std::vector<cv::Point2f>& imagePoints,
+        std::vector<int>& pointIds) const override;
+
+    bool hasCorners() const override;
+
+    bool allowsPartialViews() const override;
+
+    /**
+     * The size is the number of inner corners like getSize(), the markers are scaled with the
+     * squares.
+     */
+    std::shared_ptr<const CalibrationPattern> withGeometry(
+        const cv::Size2i& newSize, const float newSpacing) const override;
+
+    float getMarkerWidth() const;
+    int getDictionaryId() const;
+
+protected:
+    struct Detector;
+
+    /**
+     * The side length of the markers.
+     */
+    float markerWidth;
+
+    /**
+     * The predefined ArUco dictionary of the markers.
+     */
+    int dictionaryId;
+
+    /**
+     * The OpenCV board and detector, shared by all copies of the pattern.
+     */
+    std::shared_ptr<const Detector> detector;
+};
+
+} // namespace libba
+
+#endif /* CALIBRATIONPATTERN_H_ */
@@ -0,0 +1,62 @@
+/*
+ * CalibrationSession.h
+ *
+ *  Created on: 18.10.2026
+ */
+
+#ifndef CALIBRATIONSESSION_H_
+#define CALIBRATIONSESSION_H_
+
+#include "camera_calibration/CameraCalibration.h"
+#include <map>
+#include <string>
+#include <vector>
+
+namespace libba
+{
+/**
+ * The state of an application which is stored in a session file, so that a calibration can be
+ * continued or inspected later without detecting the patterns again.
+ */
+struct CalibrationSession
+{
+    struct Image
+    {
+        std::string filePath;
+
+        /**
+         * True if the image is used for the next calibration.
+         */
+        bool checked = true;
+    };
+
+    /**
+     * All images of the session, including the images which are not used.
+     */
+    std::vector<Image> images;
+
+    /**
+     * Settings of the application like the board parameters and the calibration flags, stored
+     * by name as text.
+     */
+    std::map<std::string, std::string> settings;
+};
+
+/**
+ * Saves a session. The session file is a small JSON file with the images and settings. The
+ * current result of the calibration, including the detections of all views, is written next to
+ * it as .bcal file (filePath + ".bcal"), which is only mapped when the session is loaded.
+ * Throws a std::runtime_error if a file can not be written.
+ */
+void saveSession(const std::string& filePath, const CalibrationSession& session,
+    const CameraCalibration& calibration);
+
+/**
+ * Loads a session and publishes its result in the calibration, if the session has one. No image
+ * is read. Throws a std::runtime_error if the session or its result can not be read.
+ */
+CalibrationSession loadSession(const std::string& filePath, CameraCalibration& calibration);
+
+} // namespace libba
+
+#endif /* CALIBRATIONSESSION_H_ */
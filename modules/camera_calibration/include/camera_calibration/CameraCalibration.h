@@ -8,7 +8,15 @@
 #ifndef CAMERACALIBRATION_H
 #define CAMERACALIBRATION_H
 
+#include "camera_calibration/BatchedFileReader.h"
+#include "camera_calibration/CalibrationPattern.h"
+#include "camera_calibration/DetectionWorkerPool.h"
+#include "camera_calibration/PerceptualHash.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <functional>
+#include <memory>
 #include <opencv2/opencv.hpp>
 #include <regex>
 #include <string>
@@ -22,34 +30,327 @@ class CameraCalibration
 public:
     CameraCalibration();
 
+    /**
+     * Reason why the pattern detection was skipped for an image.
+     */
+    enum class SkipReason
+    {
+        None,
+        NearDuplicate,
+        Blurred,
+        BadExposure,
+        TimedOut
+    };
+
+    /**
+     * Ways to search the chessboard corners, from the cheapest to the most robust one.
+     */
+    enum class DetectionStrategy
+    {
+        /**
+         * cv::findChessboardCorners() with a fast check on the downscaled image.
+         */
+        DownscaledFastCheck,
+
+        /**
+         * cv::findChessboardCorners() with an adaptive threshold and quad filtering.
+         */
+        Default,
+
+        /**
+         * Like Default, but the image is normalized before the thresholding.
+         */
+        AdaptiveNormalize,
+
+        /**
+         * The sector based cv::findChessboardCornersSB().
+         */
+        SectorBased,
+
+        /**
+         * cv::findChessboardCornersSB() with the flag cv::CALIB_CB_ACCURACY.
+         */
+        SectorBasedAccuracy,
+
+        /**
+         * The SIMD saddle point detector findChessboardCornersSaddle().
+         */
+        SaddlePoint
+    };
+
+    /**
+     * Number of attempts, successes and the total time in milliseconds of a strategy of the
+     * detection ladder.
+     */
+    struct StrategyStatistics
+    {
+        size_t attempts = 0;
+        size_t successes = 0;
+        double totalTime = 0;
+    };
+
+    /**
+     * Combinations of the pattern detection and the subpixel refinement of the corners.
+     */
+    enum class DetectionBackend
+    {
+        /**
+         * The detection ladder with cv::findChessboardCorners() and cv::cornerSubPix().
+         */
+        ClassicCornerSubPix,
+
+        /**
+         * The detection ladder with cv::findChessboardCorners() and cv::find4QuadCornerSubpix().
+         */
+        ClassicFind4Quad,
+
+        /**
+         * cv::findChessboardCornersSB() without a further refinement.
+         */
+        SectorBased,
+
+        /**
+         * cv::findChessboardCornersSB() with the flag cv::CALIB_CB_ACCURACY.
+         */
+        SectorBasedAccuracy,
+
+        /**
+         * The SIMD saddle point detector findChessboardCornersSaddle() and cv::cornerSubPix().
+         */
+        SaddlePoint
+    };
+
+    /**
+     * Result of a pattern detection with a time budget.
+     */
+    enum class DetectionStatus
+    {
+        Found,
+        NotFound,
+        TimedOut
+    };
+
     struct CalibImgInfo
     {
         std::string filePath = "";
         bool patternFound = false;
         std::vector<cv::Point2f> boardCornersImg;
+
+        /**
+         * The ids of the pattern points in boardCornersImg. A view of a complete pattern has the
+         * ids 0 to n - 1.
+         */
+        std::vector<int> pointIds;
         float reprojectionError = -1;
+
+        /**
+         * Time in milliseconds which was needed to load the image and detect the pattern.
+         */
+        float detectionTime = 0;
+
+        /**
+         * Index of the frame in the video filePath or -1 if the image is not from a video.
+         */
+        int frameIndex = -1;
+
+        /**
+         * True if the corners were tracked from the previous frame instead of being detected.
+         */
+        bool cornersTracked = false;
+
+        /**
+         * True if the pattern was found in the region around the board of the previous image.
+         */
+        bool detectedInRoi = false;
+
+        /**
+         * True if the pattern detection exceeded the time budget. The pattern can still be found
+         * by the retry on the downscaled image.
+         */
+        bool detectionTimedOut = false;
+
+        /**
+         * The strategy of the detection ladder which found the pattern.
+         */
+        DetectionStrategy detectionStrategy = DetectionStrategy::Default;
+
+        /**
+         * True if the image was used by the solver. Images with a found pattern are not used if
+         * they were not selected because of the maximum number of calibration views.
+         */
+        bool usedForCalibration = false;
+
+        /**
+         * Reason why the pattern was not searched in the image.
+         */
+        SkipReason skipReason = SkipReason::None;
+
+        /**
+         * Perceptual hash of the image, only computed if near-duplicates are skipped.
+         */
+        uint64_t perceptualHash = 0;
+
+        /**
+         * Variance of the Laplacian of the downscaled image, low values indicate blur. The
+         * quality scores are 0 if they were not computed, see setComputeQualityScores().
+         */
+        float sharpness = 0;
+
+        /**
+         * Fraction of the pixels of the downscaled image which are nearly black or white.
+         */
+        float clippedRatio = 0;
+
+        /**
+         * Pose of the pattern relative to the camera as Rodrigues rotation vector and
+         * translation. Only valid if the pattern was found.
+         */
+        cv::Vec3d rotation = cv::Vec3d(0, 0, 0);
+        cv::Vec3d translation = cv::Vec3d(0, 0, 0);
     };
 
+    /**
+     * Defines which frames of a video are used for the calibration.
+     */
+    struct VideoSampling
+    {
+        /**
+         * Every frameStride-th frame is used.
+         */
+        int frameStride = 1;
+
+        /**
+         * If greater than zero, frames are used with this rate in frames per second instead of
+         * frameStride. Ignored if the video does not provide its frame rate.
+         */
+        double sampleRate = 0;
+
+        /**
+         * Maximum number of used frames, 0 for no limit.
+         */
+        size_t maxFrames = 0;
+    };
+
+    /**
+     * Immutable result of a calibration or of loaded camera parameters. A result is never changed
+     * after it was published, so it can be used by any thread while a new calibration runs.
+     */
+    struct CalibrationResult
+    {
+        cv::Mat cameraMatrix;
+        cv::Mat distCoeffs;
+        size_t numDistortionCoefficents = 0;
+
+        /**
+         * The flags of cv::calibrateCamera(), they define the distortion model.
+         */
+        int calibrationFlags = 0;
+        cv::Size2i imageSize;
+        cv::Size2i chessboardSize;
+        float reprojectionError = 0;
+
+        /**
+         * The calibration pattern, used to draw the found points.
+         */
+        std::shared_ptr<const CalibrationPattern> pattern;
+
+        /**
+         * Information about the images of the calibration, empty for loaded camera parameters.
+         */
+        std::vector<CalibImgInfo> images;
+
+        /**
+         * The number of images which were used for the calibration.
+         */
+        size_t numUsedImages = 0;
+    };
+
+    using CalibrationResultPtr = std::shared_ptr<const CalibrationResult>;
+
+    struct ImageProblem
+    {
+        size_t index = 0;
+        std::string filePath;
+        std::string message;
+    };
+
+    /**
+     * Function which is called with the index of an image and its current information whenever
+     * the information of the image changed during the calibration.
+     */
+    using ImageResultFunc = std::function<void(size_t, const CalibImgInfo&)>;
+
     /**
      * Executes the camera calibration with the current files.
      * @param statusFunc A function which is called if the progress changes.
+     * @param imageResultFunc Optional function which is called after the pattern detection of
+     * every image and again for every used image after the reprojection errors are known. It is
+     * called from the thread that runs the calibration.
      */
-    void calibrateCamera(const std::function<void(int, int, std::string)> progressFunc);
+    void calibrateCamera(const std::function<void(int, int, std::string)> progressFunc,
+        const ImageResultFunc& imageResultFunc = ImageResultFunc());
 
     /**
-     * Stops the calibration.
+     * Executes the camera calibration with frames of a video. The frames are read with
+     * cv::VideoCapture and the pattern is detected directly on the decoded frames. Skipped frames
+     * are only grabbed and not retrieved. The sampled frames replace the current files, their
+     * information contains the path of the video and the frame index.
+     */
+    void calibrateCameraFromVideo(const std::string& videoPath, const VideoSampling& sampling,
+        const std::function<void(int, int, std::string)> progressFunc,
+        const ImageResultFunc& imageResultFunc = ImageResultFunc());
+
+    /**
+     * Checks all images before the calibration by reading only their headers in parallel. Finds
+     * images which can not be read, have an unsupported format or a different size than the
+     * first image. calibrateCamera() calls this function and throws if problems are found.
+     */
+    std::vector<ImageProblem> validateImages() const;
+
+    /**
+     * Stops the calibration. This function does not wait until the calibration has stopped, it
+     * can be called from any thread. A running calibration notices the request within 50 ms
+     * during the pattern detection and after a chunk of the corner refinement. The solver is
+     * only interrupted if setInterruptibleSolver() is enabled, otherwise it finishes its run.
      */
     void stopCalibration();
 
     /**
-     * Stores the calculated camera parameters in opencv filestorage format.
+     * If enabled, the solver runs in steps of a few iterations and a stop request is noticed
+     * between them. Every step restarts cv::calibrateCamera() with the intrinsics of the last
+     * step, but the poses and the damping of the optimization are initialized again. The result
+     * therefore differs slightly from the single run of the solver which is used by default.
+     */
+    void setInterruptibleSolver(const bool enabled);
+
+    /**
+     * Stores the calculated camera parameters, the format is chosen by the extension: opencv
+     * filestorage (.xml), JSON (.json), JSON with all views (.views.json) or the binary format
+     * with all views (.bcal).
      */
     void saveCameraParameters(const std::string& filePath) const;
 
+    /**
+     * Stores the current result as opencv filestorage or JSON without the views. Throws a
+     * std::runtime_error if there is no result.
+     */
     void exportCameraParametersCv(const std::string& filePath) const;
 
     void exportCameraParametersJSON(const std::string& filePath) const;
 
+    /**
+     * Stores the current result with the poses, observations and residuals of all views as JSON,
+     * see CalibrationJsonFile.h. The views are streamed to the file, so the memory does not grow
+     * with their number. Throws a std::runtime_error if there is no result.
+     */
+    void exportCameraParametersJSONWithViews(const std::string& filePath) const;
+
+    /**
+     * Stores the current result with the poses, observations and residuals of all views as .bcal
+     * file, see BcalFile.h. Throws a std::runtime_error if there is no result.
+     */
+    void exportCameraParametersBinary(const std::string& filePath) const;
+
     /**
      * Computes the reprojection error of the last camera calibration.
      */
@@ -64,11 +365,37 @@ public:
 
     void loadCameraParametersJSON(const std::string& filePath);
 
-    const cv::Mat& getCameraMatrix() const;
-    const cv::Mat& getDistCoeffs() const;
+    /**
+     * Loads a .bcal file. Unlike the other formats it restores the pattern, the distortion model
+     * and the information of all views, so the result can be inspected like after a calibration.
+     */
+    void loadCameraParametersBinary(const std::string& filePath);
+
+    /**
+     * Loads camera parameters, the format is chosen by the extension like in
+     * saveCameraParameters(). Throws a std::runtime_error for unknown extensions.
+     */
+    void loadCameraParameters(const std::string& filePath);
+
+    /**
+     * Returns the current result or nullptr if no camera parameters were calculated or loaded.
+     * This function can be called from any thread, the returned result stays valid and unchanged
+     * even if a new calibration finishes in the meantime.
+     */
+    CalibrationResultPtr getResult() const;
 
     /**
-     * Returns the number of distortion coefficents for a specific distortion model.
+     * Returns the camera matrix of the current result.
+     */
+    cv::Mat getCameraMatrix() const;
+
+    /**
+     * Returns the distortion coefficients of the current result.
+     */
+    cv::Mat getDistCoeffs() const;
+
+    /**
+     * Returns the number of distortion coefficents of the current result, 0 if there is none.
      */
     size_t getNumDistortionCoefficents() const;
     std::vector<std::string> getFiles() const;
@@ -78,14 +405,138 @@ public:
     void removeFile(const int index);
     void clearFiles();
 
+    /**
+     * Sets the calibration target. The detection ladder, the detection backends, the corner
+     * tracking and the retry after a timeout are only used for chessboards. The other patterns
+     * are searched with CalibrationPattern::detect() within the time budget.
+     */
+    void setPattern(const std::shared_ptr<const CalibrationPattern>& calibrationPattern);
+    std::shared_ptr<const CalibrationPattern> getPattern() const;
+
+    /**
+     * Changes the number of points per row and the number of rows of the current pattern, e.g.
+     * the inner corners of a chessboard. The type and the spacing of the pattern are kept.
+     */
     void setChessboardSize(const cv::Size2i& chessboardSize);
     void setCornerRefinmentWindowSize(const cv::Size2i& cornerRefinmentWindowSize);
+
+    /**
+     * Changes the spacing of the current pattern, e.g. the square width of a chessboard. The type
+     * and the number of points of the pattern are kept.
+     */
     void setChessboardSquareWidth(const float chessboardSquareWidth);
+
+    /**
+     * If enabled, calibrateCameraFromVideo() follows the corners of the last frame with the
+     * pyramidal Lucas-Kanade optical flow instead of searching the pattern in every frame. The
+     * pattern is only detected if the tracking fails or the tracked grid is not plausible.
+     */
+    void setCornerTracking(const bool enabled);
+
+    /**
+     * Limits the number of views which are passed to the solver. If more images with a found
+     * pattern are available, the views which cover the image best and show the most different
+     * poses are selected. The poses and reprojection errors of the other views are estimated with
+     * the calculated intrinsics. 0 uses all views.
+     */
+    void setMaxCalibrationViews(const size_t maxViews);
+
+    /**
+     * Skips the pattern detection for images which look nearly the same as an image that was
+     * already processed in the current calibration. Images are compared by the hamming distance
+     * of their perceptual hashes, an image is skipped if the distance is at most
+     * maxHammingDistance. A negative distance disables the check, which is the default.
+     */
+    void setDuplicateThreshold(const int maxHammingDistance);
+
+    /**
+     * Skips the pattern detection for blurred or badly exposed images. The scores are computed on
+     * a copy of the image which is scaled down to at most 640 pixels.
+     * @param minSharpness Minimum variance of the Laplacian, 0 accepts all images.
+     * @param maxClippedRatio Maximum fraction of nearly black or white pixels, 1 accepts all
+     * images.
+     */
+    void setQualityThresholds(const float minSharpness, const float maxClippedRatio);
+
+    /**
+     * Computes the sharpness and the clipped ratio of every image, e.g. to show them. By default
+     * they are only computed if a quality threshold is set and are 0 otherwise.
+     */
+    void setComputeQualityScores(const bool enabled);
+
+    /**
+     * Limits the time of the pattern detection per image. A detection which exceeds the budget
+     * is abandoned and, if enabled, retried once on a downscaled copy of the image with the same
+     * budget. Images without a pattern after a timeout get the skip reason TimedOut.
+     * Abandoned detections finish in the background, so they still use CPU time. At most one
+     * detection per core runs at a time, if all are busy the next detection waits for a free core
+     * and its budget starts when it runs.
+     * @param milliseconds The time budget, 0 for no limit.
+     */
+    void setDetectionTimeBudget(const float milliseconds, const bool retryDownscaled = true);
+
+    /**
+     * Sets the strategies which are tried one after another until the pattern is found. The
+     * default ladder only contains DetectionStrategy::Default.
+     * @param adaptiveStart If true, the ladder starts with the strategy which minimizes the
+     * expected detection time according to the previously processed images. The statistics are
+     * kept across calibrations and are only reset if the strategies change. The whole ladder is
+     * still run regularly to keep the statistics of all strategies current.
+     */
+    void setDetectionLadder(
+        const std::vector<DetectionStrategy>& strategies, const bool adaptiveStart = true);
+
+    /**
+     * Sets the pattern detection and corner refinement. The detection ladder is only used by the
+     * classic backends. Corners which were found by a sector based detector are not refined
+     * further. Corners from the tracking or the retry after a timeout are refined with
+     * cv::cornerSubPix() if a sector based backend is used.
+     */
+    void setDetectionBackend(const DetectionBackend backend);
+
+    /**
+     * If enabled, the pattern is first searched in a region around the board position of the
+     * previous image and only in the whole image if it is not found there. This speeds up the
+     * detection for sequential captures in which the board moves little.
+     * @param padding Padding around the bounding box of the last board relative to its size.
+     */
+    void setRoiDetection(const bool enabled, const float padding = 0.3f);
+
+    /**
+     * Sets how many images are read ahead of the detection, see BatchedFileReader. The files are
+     * read with io_uring if it is available and useIoUring is set, otherwise by a thread pool.
+     * @param files Number of files which are read ahead, 0 reads every image when it is needed.
+     */
+    void setReadAhead(const size_t files, const bool useIoUring = true);
+
+    /**
+     * Returns the throughput of the file reads of the last calibration with images. Only
+     * available if the images were read ahead.
+     */
+    BatchedFileReader::Statistics getReadStatistics() const;
+
+    /**
+     * Appends the detection result of every image to a journal while calibrateCamera() runs, see
+     * DetectionJournal. If resume is set, the results of an earlier run with the same detection
+     * settings are read from the journal first and only the remaining images are processed. An
+     * empty path disables the journal. Results of images whose file changed since they were
+     * journaled are not used. The journal is deleted when the calibration has finished
+     * successfully. Calibrations from videos are not journaled.
+     */
+    void setJournal(const std::string& filePath, const bool resume = true);
     bool isStopRequested() const;
-    float getReprojectionError() const;
 
+    /**
+     * Returns the time in milliseconds between the last stop request and the end of the stopped
+     * calibration or -1 if the last calibration was not stopped.
+     */
+    float getStopLatency() const;
+    float getReprojectionError() const;
 
-    const std::vector<CalibImgInfo>& getCalibInfo() const;
+    /**
+     * Returns the information about the images of the current result.
+     */
+    std::vector<CalibImgInfo> getCalibInfo() const;
     bool isCalibrationDataAvailable() const;
 
     cv::Size getChessboardSize() const;
@@ -94,15 +545,150 @@ public:
     void setCalibrationFlags(const int calibrationFlags);
 
 protected:
+    /**
+     * Resets the stop request, runs the calibration function and measures the stop latency.
+     */
+    void runStoppable(const std::function<void()>& calibrationFunc);
+
+    void runCalibration(const std::function<void(int, int, std::string)>& progressFunc,
+        const ImageResultFunc& imageResultFunc);
+    void runVideoCalibration(const std::string& videoPath, const VideoSampling& sampling,
+        const std::function<void(int, int, std::string)>& progressFunc,
+        const ImageResultFunc& imageResultFunc);
+
+    /**
+     * Resets the data of the last calibration before the detection starts and prepares the
+     * memory for the observations of expectedViews images.
+     */
+    void startDetection(const size_t expectedViews);
+
+    /**
+     * Reads and decodes an image as grayscale image into the reused decode buffer. The returned
+     * image refers to the buffer and is only valid until the next image is read.
+     * @param fileReader The next file of the reader is used if it is set, it has to be the file
+     * with filePath. Members of archives are decoded from the mapped archive without the reader.
+     */
+    cv::Mat readGrayscaleImage(const std::string& filePath, BatchedFileReader* fileReader);
+
+    /**
+     * Detects the pattern on a grayscale image and stores the result in calibImages[idx]. Returns
+     * false if the calibration was stopped.
+     * @param previousCorners Corners of the previous frame of a video which are tracked into the
+     * image after the quality and duplicate checks, the detection runs if the tracking fails.
+     */
+    bool processImage(const cv::Mat& img, const size_t idx,
+        const std::chrono::steady_clock::time_point& startTime,
+        const ImageResultFunc& imageResultFunc, const cv::Mat& previousImg = cv::Mat(),
+        const std::vector<cv::Point2f>& previousCorners = std::vector<cv::Point2f>());
+
+    /**
+     * Searches the chessboard corners with the strategies of the detection ladder.
+     * @param preview Downscaled copy of the image.
+     */
+    bool detectCorners(const cv::Mat& img, const cv::Mat& preview,
+        std::vector<cv::Point2f>& corners, CalibImgInfo& imgInfo);
+
+    /**
+     * Searches a pattern which is not a chessboard with CalibrationPattern::detect().
+     */
+    bool detectPattern(const cv::Mat& img, std::vector<cv::Point2f>& points,
+        std::vector<int>& pointIds, CalibImgInfo& imgInfo) const;
+
+    /**
+     * Searches the chessboard corners with one strategy, first in the region of the last board
+     * if enabled.
+     */
+    DetectionStatus detectWithStrategy(const DetectionStrategy strategy, const cv::Mat& img,
+        const cv::Mat& preview, const std::chrono::steady_clock::time_point& deadline,
+        std::vector<cv::Point2f>& corners, CalibImgInfo& imgInfo) const;
+
+    /**
+     * Returns the index of the strategy in the detection ladder which is tried first.
+     */
+    size_t selectLadderStart() const;
+
+    /**
+     * Returns the end of the time budget of a detection which starts now.
+     */
+    std::chrono::steady_clock::time_point detectionDeadline() const;
+
+    /**
+     * Tracks the corners of the previous frame into the current frame. Returns false if a
+     * corner was lost or the tracked corners do not form a valid grid.
+     */
+    bool trackCorners(const cv::Mat& previousImg, const cv::Mat& img,
+        const std::vector<cv::Point2f>& previousCorners, std::vector<cv::Point2f>& corners);
+
+    /**
+     * Restores the result of an image from the journal of an earlier run, including the state
+     * of the detection which the following images depend on. The journaled ladder statistics
+     * are only added if mergeStatistics is true.
+     */
+    void restoreImage(const size_t idx, const CalibImgInfo& info,
+        const std::vector<StrategyStatistics>& journaledStatistics, const bool mergeStatistics,
+        const ImageResultFunc& imageResultFunc);
+
+    /**
+     * Returns a hash of all settings which change the result of the pattern detection. Journals
+     * are only resumed with the same settings.
+     */
+    uint64_t detectionFingerprint() const;
+
+    /**
+     * Calculates the camera parameters from the detected corners. Returns false if the
+     * calibration was stopped.
+     */
+    bool solve();
+
+    /**
+     * Computes the reprojection errors and publishes the result.
+     */
+    void finishCalibration(const ImageResultFunc& imageResultFunc);
+
+    /**
+     * Refines the corners with subpixel accuracy. Boards with many corners are refined in
+     * parallel. Returns false if the refinement was stopped.
+     */
+    bool refineCorners(const cv::Mat& img, std::vector<cv::Point2f>& corners) const;
+
+    void updateStopLatency();
+
+    /**
+     * Buffers of the detection loop which are reused for every image. Once they have the size of
+     * the images and the pattern, the loop of a chessboard without a detection time budget only
+     * allocates memory to store the results of an image, e.g. its corners and its hash. With a time
+     * budget every detection works on a copy of the image, and the detectors of the other patterns
+     * keep their own reference to the pattern. The allocations inside of OpenCV, e.g. by the image
+     * decoders and the pattern detectors, remain.
+     */
+    struct DetectionBuffers
+    {
+        std::vector<uchar> fileData;
+        cv::Mat image;
+        cv::Mat preview;
+        cv::Mat laplacian;
+        std::vector<cv::Point2f> corners;
+        std::vector<int> pointIds;
+        std::vector<cv::Point2f> backTrackedCorners;
+        std::vector<uchar> trackingStatus;
+        std::vector<float> trackingErrors;
+    };
+
+    /**
+     * Creates a new result from the current calibration data and publishes it. If withImages is
+     * false, the result does not contain any calibration images, e.g. for loaded camera parameters.
+     */
+    void publishResult(const bool withImages = true);
+
     /**
      * Contains the filepaths to the calibration images.
      */
     std::vector<CalibImgInfo> calibImages;
 
     /**
-     * The number of inner checkerboard corners.
+     * The calibration target.
      */
-    cv::Size2i chessboardCorners;
+    std::shared_ptr<const CalibrationPattern> pattern;
 
     /**
      * The size of the images which where used.
@@ -114,11 +700,6 @@ protected:
      */
     cv::Size2i cornerRefinmentWindowSize;
 
-    /**
-     * The size of the squares on the calibration pattern.
-     */
-    float chessboardSquareWidth;
-
     /**
      * The calculated calibration matrix.
      */
@@ -149,10 +730,166 @@ protected:
      */
     std::vector<std::vector<cv::Point3f> > patternCorners;
 
+    /**
+     * Point vectors of the observations of the last calibration. They are reused for the
+     * observations of the next calibration, so that storing an observation does not allocate.
+     */
+    std::vector<std::vector<cv::Point2f> > spareImgCorners;
+    std::vector<std::vector<cv::Point3f> > sparePatternCorners;
+
+    /**
+     * Index of the image in calibImages for every element of imgCorners.
+     */
+    std::vector<size_t> observationImageIdx;
+
+    /**
+     * Indices into imgCorners of the views which are used by the solver in ascending order. The
+     * rotation and translation vectors belong to these views.
+     */
+    std::vector<size_t> selectedObservations;
+
+    /**
+     * Maximum number of views which are used by the solver, 0 for no limit.
+     */
+    size_t maxCalibrationViews;
+
+    /**
+     * Maximum hamming distance of the perceptual hashes of two near-duplicate images or -1 if
+     * near-duplicates are not skipped.
+     */
+    int duplicateThreshold;
+
+    /**
+     * Perceptual hashes of the images which were processed in the current calibration.
+     */
+    PerceptualHashIndex imageHashes;
+
+    /**
+     * Images with a lower sharpness score are not used.
+     */
+    float minSharpness;
+
+    /**
+     * Images with a higher fraction of clipped pixels are not used.
+     */
+    float maxClippedRatio;
+
+    /**
+     * The quality scores are computed even if no quality threshold is set.
+     */
+    bool computeQualityScores;
+
+    /**
+     * Time budget in milliseconds of the pattern detection per image, 0 for no limit.
+     */
+    float detectionTimeBudget;
+
+    /**
+     * If set to true, a timed out detection is retried on a downscaled image.
+     */
+    bool retryDetectionOnTimeout;
+
+    /**
+     * Strategies which are tried one after another to find the pattern.
+     */
+    std::vector<DetectionStrategy> detectionLadder;
+
+    /**
+     * If set to true, the ladder starts with the strategy of the lowest expected cost.
+     */
+    bool adaptiveLadderStart;
+
+    /**
+     * Statistics of every strategy of the ladder since the ladder was set.
+     */
+    std::vector<StrategyStatistics> ladderStatistics;
+
+    /**
+     * Number of detections with the ladder since the ladder was set.
+     */
+    size_t ladderDetections;
+
+    /**
+     * The part of the ladder statistics of the image which is processed, it is journaled with
+     * the result of the image.
+     */
+    std::vector<StrategyStatistics> imageLadderStatistics;
+
+    /**
+     * The pattern detection and corner refinement which is used.
+     */
+    DetectionBackend detectionBackend;
+
+    /**
+     * Threads of the pattern detections. Abandoned detections keep running on them, the
+     * destructor waits until they have finished.
+     */
+    mutable DetectionWorkerPool detectionWorkers;
+
+    /**
+     * Reused buffers of the detection loop.
+     */
+    DetectionBuffers detectionBuffers;
+
+    /**
+     * Options of the reader of the calibration images, readAhead 0 disables the reader.
+     */
+    BatchedFileReader::Options fileReaderOptions;
+
+    /**
+     * Throughput of the file reads of the last calibration with images.
+     */
+    BatchedFileReader::Statistics readStatistics;
+
+    /**
+     * Path of the journal of the detection results, empty if no journal is written.
+     */
+    std::string journalPath;
+
+    /**
+     * If set to true the results in the journal are used instead of processing the images again.
+     */
+    bool resumeFromJournal;
+
+    /**
+     * If set to true the corners are tracked between the frames of a video.
+     */
+    bool cornerTrackingEnabled;
+
+    /**
+     * If set to true the pattern is searched around the board of the last image first.
+     */
+    bool roiDetectionEnabled;
+
+    /**
+     * Padding of the search region relative to the size of the last board.
+     */
+    float roiPadding;
+
+    /**
+     * Bounding box of the corners in the last image, empty if the pattern was not found.
+     */
+    cv::Rect lastBoardRect;
+
+    /**
+     * If set to true the solver runs in steps which can be interrupted.
+     */
+    bool interruptibleSolver;
+
     /**
      * If set to true the calibration process is stopped at the next possible date.
      */
-    bool stopRequested;
+    std::atomic<bool> stopRequested;
+
+    /**
+     * Time of the last stop request in ticks of std::chrono::steady_clock.
+     */
+    std::atomic<int64_t> stopRequestTime;
+
+    /**
+     * Time in milliseconds the last calibration needed to stop.
+     */
+    float stopLatency;
 
     /**
      * Contains the reprojection error of the current camera calibration.
@@ -160,9 +897,10 @@ protected:
     float reprojectionError;
 
     /**
-     * Indicates if calibration data is available.
+     * The last published result. It is only accessed with std::atomic_load and
+     * std::atomic_store.
      */
-    bool calibDataAvailabel;
+    CalibrationResultPtr result;
 
     /**
      * Flags that are passed to the function cv::calibrateCamera .
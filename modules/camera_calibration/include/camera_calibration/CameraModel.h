@@ -0,0 +1,78 @@
+/*
+ * CameraModel.h
+ *
+ *  Created on: 18.10.2026
+ */
+
+#ifndef CAMERAMODEL_H_
+#define CAMERAMODEL_H_
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace libba
+{
+/**
+ * Number of distortion coefficients of a CameraModel, the maximum of cv::calibrateCamera().
+ */
+constexpr size_t cameraModelMaxDistortionCoefficients = 14;
+
+/**
+ * The intrinsics of a camera from a calibration file. Unlike a CameraCalibration it has a fixed
+ * size and owns no memory, so the models of many cameras are stored in one contiguous array.
+ */
+struct CameraModel
+{
+    double fx = 0;
+    double fy = 0;
+    double cx = 0;
+    double cy = 0;
+
+    /**
+     * The first numDistortionCoefficients values are used, the others are zero.
+     */
+    std::array<double, cameraModelMaxDistortionCoefficients> distortion = {};
+    uint32_t numDistortionCoefficients = 0;
+    int32_t width = 0;
+    int32_t height = 0;
+
+    /**
+     * jsonInvalidReprojectionError if the JSON file contained null.
+     */
+    float reprojectionError = 0;
+};
+
+/**
+ * The models of a list of files. The models and errors have one entry per file in the order of
+ * the files. The model of a file which could not be loaded is zero and its error is set.
+ */
+struct CameraModelSet
+{
+    std::vector<CameraModel> models;
+
+    /**
+     * The reason why a file could not be loaded or an empty string.
+     */
+    std::vector<std::string> errors;
+    size_t numFailed = 0;
+};
+
+/**
+ * Loads the camera model of a file which was written by CameraCalibration::saveCameraParameters()
+ * (.xml, .json, .views.json or .bcal). The views of .views.json and .bcal files are skipped. The
+ * model is checked for a positive focal length and image size and finite values. Throws a
+ * std::runtime_error if the file can not be read, is damaged or contains an invalid model.
+ */
+CameraModel loadCameraModel(const std::string& filePath);
+
+/**
+ * Loads the camera models of many files in parallel. It does not throw for damaged files, their
+ * errors are reported in the returned set instead.
+ */
+CameraModelSet loadCameraModels(const std::vector<std::string>& filePaths);
+
+} // namespace libba
+
+#endif /* CAMERAMODEL_H_ */
@@ -0,0 +1,128 @@
+/*
+ * DetectionJournal.h
+ *
+ *  Created on: 18.10.2026
+ */
+
+#ifndef DETECTIONJOURNAL_H_
+#define DETECTIONJOURNAL_H_
+
+#include "camera_calibration/CameraCalibration.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace libba
+{
+/**
+ * Append-only file with the detection result of every processed image, so that a calibration
+ * which was stopped or crashed can be resumed without detecting the patterns again.
+ *
+ * The file starts with a header (magic, version, fingerprint of the detection settings) which is
+ * followed by one record per image: the size of the payload, its CRC-32 and the payload. The
+ * payload is the index of the image, the image size, a BcalView, the size and modification time
+ * of the image file, the file path, the points as BcalPoint and the ladder statistics of the
+ * image, all in the byte order of the host. A record which was only partly written when the
+ * process died fails the CRC check and is cut off together with everything after it. The journal
+ * of a finished calibration is removed, so every existing journal belongs to an incomplete run.
+ */
+class DetectionJournal
+{
+public:
+    struct Entry
+    {
+        size_t imageIdx = 0;
+        cv::Size2i imageSize;
+        CameraCalibration::CalibImgInfo info;
+
+        /**
+         * Size and modification time of the image file when the record was written, of the
+         * archive for members of archives. Both are 0 if the file did not exist.
+         */
+        uint64_t fileSize = 0;
+        int64_t modificationTime = 0;
+
+        /**
+         * The attempts of the detection ladder for this image, one element per rung.
+         */
+        std::vector<CameraCalibration::StrategyStatistics> ladderStatistics;
+    };
+
+    /**
+     * Number of records after which the journal is synced to the disk by default.
+     */
+    static constexpr size_t defaultSyncInterval = 32;
+
+    /**
+     * Opens the journal. If resume is true and the journal was written with the same
+     * fingerprint, its valid records are read and new records are appended after them.
+     * Otherwise the journal is started again. Throws a std::runtime_error if the file can not be
+     * opened or written.
+     * @param syncInterval Number of appended records after which the file is synced with
+     * fdatasync(). Every record is written immediately, so it survives a crash of the process,
+     * the sync makes it survive a crash of the system.
+     */
+    DetectionJournal(const std::string& filePath, const uint64_t fingerprint, const bool resume,
+        const size_t syncInterval = defaultSyncInterval);
+
+    /**
+     * Syncs the remaining records unless the journal was removed.
+     */
+    ~DetectionJournal();
+
+    DetectionJournal(const DetectionJournal&) = delete;
+    DetectionJournal& operator=(const DetectionJournal&) = delete;
+
+    /**
+     * Returns the records which were read when the journal was opened, in the order in which
+     * they were written.
+     */
+    const std::vector<Entry>& getEntries() const;
+
+    /**
+     * Returns true if the image file of the entry still has the size and modification time with
+     * which it was journaled.
+     */
+    bool isFileUnchanged(const Entry& entry) const;
+
+    /**
+     * Appends the result of an image. Throws a std::runtime_error if it can not be written.
+     */
+    void append(const size_t imageIdx, const cv::Size2i& imageSize,
+        const CameraCalibration::CalibImgInfo& info,
+        const std::vector<CameraCalibration::StrategyStatistics>& ladderStatistics);
+
+    /**
+     * Writes all appended records to the disk.
+     */
+    void sync();
+
+    /**
+     * Closes and deletes the journal after the calibration has finished. Nothing can be appended
+     * afterwards.
+     */
+    void remove();
+
+protected:
+    /**
+     * Reads the records of the file and returns the size of its valid part.
+     */
+    size_t readEntries(const std::vector<unsigned char>& data);
+
+    void write(const unsigned char* data, const size_t size);
+
+    std::string filePath;
+    int fd;
+    size_t syncInterval;
+    size_t unsyncedRecords;
+    std::vector<Entry> entries;
+
+    /**
+     * Buffer of the record which is appended, reused for all records.
+     */
+    std::vector<unsigned char> record;
+};
+
+} // namespace libba
+
+#endif /* DETECTIONJOURNAL_H_ */
@@ -0,0 +1,115 @@
+/*
+ * DetectionWorkerPool.h
+ *
+ *  Created on: 18.10.2026
+ */
+
+#ifndef DETECTIONWORKERPOOL_H_
+#define DETECTIONWORKERPOOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <opencv2/core.hpp>
+#include <thread>
+#include <vector>
+
+namespace libba
+{
+/**
+ * Threads which run the pattern detections. A detection can not be interrupted, so the caller
+ * stops waiting for it when its time budget is used up or a stop is requested and the detection
+ * finishes on its worker in the background. The number of workers is limited, so abandoned
+ * detections can not occupy more and more cores. Detections without a time budget run on an
+ * additional worker with one reusable slot for the image, the detector and the results, so they
+ * do not allocate memory per image. The destructor drops the jobs which have not started yet and
+ * waits for the running ones.
+ */
+class DetectionWorkerPool
+{
+public:
+    using Job = std::function<void()>;
+
+    /**
+     * Searches points in an image and returns their positions and the ids of the points.
+     */
+    using Detector
+        = std::function<bool(const cv::Mat&, std::vector<cv::Point2f>&, std::vector<int>&)>;
+
+    explicit DetectionWorkerPool(const size_t maxWorkers);
+    ~DetectionWorkerPool();
+
+    DetectionWorkerPool(const DetectionWorkerPool&) = delete;
+    DetectionWorkerPool& operator=(const DetectionWorkerPool&) = delete;
+
+    /**
+     * Waits until a worker is free and hands the job to it. Returns false without running the
+     * job if a stop is requested while waiting.
+     */
+    bool run(Job job, const std::atomic<bool>& stopRequested);
+
+    /**
+     * Runs the detector in the reusable slot and waits for its result. Returns false if nothing
+     * was found or if a stop is requested, the detection then finishes in the background. The
+     * image is not copied, the caller must not change its pixels before waitUntilIdle() returned.
+     * Exceptions of the detector are rethrown.
+     */
+    bool detect(const cv::Mat& img, const Detector& detector, std::vector<cv::Point2f>& points,
+        std::vector<int>& pointIds, const std::atomic<bool>& stopRequested);
+
+    /**
+     * Blocks until all jobs, including abandoned ones, have finished.
+     */
+    void waitUntilIdle();
+
+protected:
+    void work();
+    void workOnSlot();
+
+    const size_t maxWorkers;
+    std::vector<std::thread> threads;
+    std::deque<Job> jobs;
+
+    /**
+     * Number of jobs which are waiting or running.
+     */
+    size_t busyWorkers;
+    bool shutdown;
+
+    std::mutex mutex;
+
+    /**
+     * Notified when a job is added and on shutdown.
+     */
+    std::condition_variable jobAdded;
+
+    /**
+     * Notified when a job or the detection of the slot has finished.
+     */
+    std::condition_variable jobFinished;
+
+    std::thread slotThread;
+    cv::Mat slotImage;
+    Detector slotDetector;
+    std::vector<cv::Point2f> slotPoints;
+    std::vector<int> slotIds;
+    bool slotFound;
+    std::exception_ptr slotError;
+
+    /**
+     * True from handing a detection to the slot until it has finished.
+     */
+    bool slotBusy;
+
+    /**
+     * Notified when a detection is handed to the slot and on shutdown.
+     */
+    std::condition_variable slotStarted;
+};
+
+} // namespace libba
+
+#endif /* DETECTIONWORKERPOOL_H_ */
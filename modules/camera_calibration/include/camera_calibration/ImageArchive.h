@@ -0,0 +1,153 @@
+/*
+ * ImageArchive.h
+ *
+ *  Created on: 18.10.2026
+ */
+
+#ifndef IMAGEARCHIVE_H_
+#define IMAGEARCHIVE_H_
+
+#include "camera_calibration/MappedFile.h"
+#include <memory>
+#include <opencv2/core.hpp>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace libba
+{
+/**
+ * A tar or zip archive which is memory mapped and indexed once, so that its members can be
+ * decoded directly from the mapped file without extracting them. Members of an archive are
+ * addressed with virtual paths of the form "archive.tar!/dir/image.png", these paths can be used
+ * like regular file paths for the calibration images.
+ * Only uncompressed zip members can be read (zip -0), images are already compressed anyway.
+ */
+class ImageArchive
+{
+public:
+    struct Member
+    {
+        /**
+         * The path of the member inside of the archive.
+         */
+        std::string name;
+
+        /**
+         * Position of the member data in the archive file.
+         */
+        size_t offset = 0;
+        size_t size = 0;
+
+        /**
+         * Set to true for zip members which are compressed or encrypted.
+         */
+        bool compressed = false;
+    };
+
+    /**
+     * Maps and indexes an archive. The format is chosen by the extension (.tar or .zip). Throws
+     * a std::runtime_error if the archive can not be read or is damaged.
+     */
+    explicit ImageArchive(const std::string& archivePath);
+    ~ImageArchive();
+
+    ImageArchive(const ImageArchive&) = delete;
+    ImageArchive& operator=(const ImageArchive&) = delete;
+
+    /**
+     * Returns the archive from a cache of opened archives, so that the members of an archive can
+     * be read one after another without indexing it again. An archive is opened again if its
+     * size or modification time changed. The archives stay mapped until closeCachedArchives() is
+     * called, which CameraCalibration does at the end of a calibration.
+     */
+    static std::shared_ptr<const ImageArchive> open(const std::string& archivePath);
+
+    /**
+     * Removes all archives from the cache, they are unmapped when their last user is done.
+     */
+    static void closeCachedArchives();
+
+    /**
+     * Returns true if the path has the extension of a supported archive.
+     */
+    static bool isArchive(const std::string& path);
+
+    const std::string& getPath() const;
+
+    /**
+     * Returns the regular files of the archive in the order in which they are stored.
+     */
+    const std::vector<Member>& getMembers() const;
+
+    /**
+     * Returns the member with the given name or nullptr if there is none.
+     */
+    const Member* findMember(const std::string& name) const;
+
+    /**
+     * Returns the virtual paths of all members with one of the extensions (e.g. ".png", compared
+     * case insensitive).
+     */
+    std::vector<std::string> getMemberPaths(const std::vector<std::string>& extensions) const;
+
+    /**
+     * Returns the mapped data of the member, which has member.size bytes. Throws a
+     * std::runtime_error if the member is compressed.
+     */
+    const unsigned char* getBytes(const Member& member) const;
+
+    /**
+     * Returns a 1 x size CV_8UC1 matrix which refers to the mapped data of the member without
+     * copying it. It can be passed to cv::imdecode(). Throws a std::runtime_error if the member
+     * is compressed.
+     */
+    cv::Mat getData(const Member& member) const;
+
+protected:
+    void indexTar();
+    void indexZip();
+
+    std::string path;
+
+    /**
+     * The mapped archive file.
+     */
+    MappedFile file;
+    const unsigned char* data;
+    size_t size;
+
+    std::vector<Member> members;
+
+    /**
+     * Index of every member in members by its name.
+     */
+    std::unordered_map<std::string, size_t> memberIndex;
+};
+
+/**
+ * Splits a virtual path "archive.tar!/member" into the path of the archive and the name of the
+ * member. Returns false if the path does not point into an archive.
+ */
+bool splitArchivePath(const std::string& path, std::string& archivePath, std::string& memberName);
+
+/**
+ * Returns the virtual path of a member of an archive.
+ */
+std::string makeArchivePath(const std::string& archivePath, const std::string& memberName);
+
+/**
+ * Returns true if the path is the virtual path of an archive member.
+ */
+bool isArchiveMemberPath(const std::string& path);
+
+/**
+ * Decodes the member of an archive with the given virtual path directly from the mapped archive.
+ * The flags and dst are used like in cv::imdecode(). Returns an empty matrix if the member can not
+ * be read or decoded.
+ */
+cv::Mat decodeArchiveMember(const std::string& path, const int flags, cv::Mat* dst = nullptr);
+
+} // namespace libba
+
+#endif /* IMAGEARCHIVE_H_ */
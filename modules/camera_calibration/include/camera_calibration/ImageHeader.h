@@ -0,0 +1,53 @@
+/*
+ * ImageHeader.h
+ *
+ *  Created on: 18.10.2026
+ */
+
+#ifndef IMAGEHEADER_H_
+#define IMAGEHEADER_H_
+
+#include <opencv2/core.hpp>
+#include <string>
+
+namespace libba
+{
+struct ImageHeader
+{
+    enum class Format
+    {
+        Unknown,
+        PNG,
+        JPEG
+    };
+
+    Format format = Format::Unknown;
+
+    /**
+     * Size of the decoded image, i.e. after the EXIF orientation is applied.
+     */
+    cv::Size2i size = cv::Size2i(-1, -1);
+
+    /**
+     * EXIF orientation of a JPEG image (1 - 8), 1 if the image has no orientation tag.
+     */
+    int orientation = 1;
+
+    /**
+     * Number of color channels stored in the file.
+     */
+    int channels = 0;
+};
+
+/**
+ * Reads the format and the size of an image from the file header (PNG IHDR chunk or JPEG SOF
+ * segment) without decoding the image data. The EXIF orientation of JPEG images is applied to the
+ * size like the decoder does. For other formats the format is Format::Unknown and
+ * the size is not set. The path can also point into a tar or zip archive, see ImageArchive.
+ * Throws a std::runtime_error if the file can not be read or the header is damaged.
+ */
+ImageHeader readImageHeader(const std::string& filePath);
+
+} // namespace libba
+
+#endif /* IMAGEHEADER_H_ */
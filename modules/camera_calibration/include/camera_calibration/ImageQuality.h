@@ -0,0 +1,57 @@
+/*
+ * ImageQuality.h
+ *
+ *  Created on: 18.10.2026
+ */
+
+#ifndef IMAGEQUALITY_H_
+#define IMAGEQUALITY_H_
+
+#include <opencv2/core.hpp>
+
+namespace libba
+{
+/**
+ * Scores which describe if an image is usable for the pattern detection.
+ */
+struct ImageQuality
+{
+    /**
+     * Variance of the Laplacian of the image. Blurred images have a low variance.
+     */
+    float sharpness = 0;
+
+    /**
+     * Fraction of the pixels which are nearly black or white.
+     */
+    float clippedRatio = 0;
+};
+
+/**
+ * Scales a grayscale image down so that its longer side has at most maxSize pixels. The scores
+ * and hashes of the image filters are computed on this image instead of the full image.
+ */
+cv::Mat createPreviewImage(const cv::Mat& img, const int maxSize);
+
+/**
+ * Like createPreviewImage(), but scales the image into preview. The memory of preview is reused
+ * if it already has the size of the scaled image. If the image is small enough, preview refers to
+ * the data of img.
+ */
+void createPreviewImage(const cv::Mat& img, const int maxSize, cv::Mat& preview);
+
+/**
+ * Computes the quality scores of a grayscale image. The sharpness depends on the image size, so
+ * only scores of images with the same size can be compared.
+ */
+ImageQuality computeImageQuality(const cv::Mat& img);
+
+/**
+ * Like computeImageQuality(), but uses laplacian as buffer for the filtered image, so that the
+ * memory can be reused for the next image.
+ */
+ImageQuality computeImageQuality(const cv::Mat& img, cv::Mat& laplacian);
+
+} // namespace libba
+
+#endif /* IMAGEQUALITY_H_ */
@@ -0,0 +1,74 @@
+/*
+ * JsonStreamWriter.h
+ *
+ *  Created on: 18.10.2026
+ */
+
+#ifndef JSONSTREAMWRITER_H_
+#define JSONSTREAMWRITER_H_
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace libba
+{
+/**
+ * Writes a JSON document event by event to a stream, like the SAX interface of nlohmann::json
+ * in the other direction. Nothing but the nesting of the open objects and arrays is stored, so
+ * documents of any size are written with constant memory.
+ *
+ * The caller is responsible for a valid order of the events: inside of objects every value has
+ * to be preceded by key().
+ */
+class JsonStreamWriter
+{
+public:
+    explicit JsonStreamWriter(std::ostream& stream);
+
+    void startObject();
+    void endObject();
+    void startArray();
+    void endArray();
+    void key(const std::string& name);
+
+    void null();
+    void boolean(const bool value);
+    void numberInteger(const int64_t value);
+
+    /**
+     * Writes a number with the given number of significant digits, 17 restore a double exactly
+     * and 9 a float. NaN and infinity are not valid JSON and are written as null.
+     */
+    void numberFloat(const double value, const int precision = 17);
+    void string(const std::string& value);
+
+    /**
+     * Writes a line break before the next value. Readers which read the stream line by line,
+     * like nlohmann::json, then only buffer one line at a time.
+     */
+    void lineBreak();
+
+protected:
+    /**
+     * Writes the separator before a value in an array or a key in an object.
+     */
+    void beginValue();
+
+    std::ostream& stream;
+
+    /**
+     * One entry for each open object or array, true if it already contains a value.
+     */
+    std::vector<bool> hasValue;
+
+    /**
+     * True after key(), the following value is not separated by a comma.
+     */
+    bool afterKey;
+};
+
+} // namespace libba
+
+#endif /* JSONSTREAMWRITER_H_ */
@@ -0,0 +1,48 @@
+/*
+ * MappedFile.h
+ *
+ *  Created on: 18.10.2026
+ */
+
+#ifndef MAPPEDFILE_H_
+#define MAPPEDFILE_H_
+
+#include <cstddef>
+#include <string>
+
+namespace libba
+{
+/**
+ * A file which is mapped read-only into memory. The pages are loaded by the kernel when they are
+ * accessed, so only the parts of the file which are used are read.
+ */
+class MappedFile
+{
+public:
+    /**
+     * Maps the whole file. Throws a std::runtime_error if the file can not be opened, is empty
+     * or can not be mapped.
+     */
+    explicit MappedFile(const std::string& filePath);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const unsigned char* getData() const;
+    size_t getSize() const;
+
+    /**
+     * Tells the kernel that the file will be read from the start to the end, so it reads ahead
+     * more aggressively.
+     */
+    void adviseSequential() const;
+
+protected:
+    const unsigned char* data;
+    size_t size;
+};
+
+} // namespace libba
+
+#endif /* MAPPEDFILE_H_ */
@@ -0,0 +1,55 @@
+/*
+ * PerceptualHash.h
+ *
+ *  Created on: 18.10.2026
+ */
+
+#ifndef PERCEPTUALHASH_H_
+#define PERCEPTUALHASH_H_
+
+#include <cstdint>
+#include <opencv2/core.hpp>
+#include <vector>
+
+namespace libba
+{
+/**
+ * Computes a 64 bit difference hash of a grayscale image. The image is scaled down to 9x8 pixels
+ * and every bit tells if a pixel is brighter than its left neighbor. Similar images have hashes
+ * with a small hamming distance.
+ */
+uint64_t computeDifferenceHash(const cv::Mat& img);
+
+/**
+ * Returns the number of different bits of two hashes.
+ */
+int hammingDistance(const uint64_t hash1, const uint64_t hash2);
+
+/**
+ * Stores the hashes of images and finds images which are similar to a new one.
+ */
+class PerceptualHashIndex
+{
+public:
+    void add(const uint64_t hash);
+    void clear();
+
+    /**
+     * Reserves memory for count hashes, so that adding them does not allocate.
+     */
+    void reserve(const size_t count);
+
+    /**
+     * Returns true if the index contains a hash with a hamming distance of at most maxDistance.
+     * The hashes are compared one by one, which takes only a few microseconds for thousands of
+     * images.
+     */
+    bool containsSimilar(const uint64_t hash, const int maxDistance) const;
+
+protected:
+    std::vector<uint64_t> hashes;
+};
+
+} // namespace libba
+
+#endif /* PERCEPTUALHASH_H_ */
@@ -0,0 +1,37 @@
+/*
+ * SaddlePointDetector.h
+ *
+ *  Created on: 18.10.2026
+ */
+
+#ifndef SADDLEPOINTDETECTOR_H_
+#define SADDLEPOINTDETECTOR_H_
+
+#include <opencv2/core.hpp>
+#include <vector>
+
+namespace libba
+{
+/**
+ * Computes the saddle point response of a grayscale image. The response is the negative
+ * determinant of the Hessian of the smoothed image, clamped at zero, and is high at the inner
+ * corners of a chessboard. The rows are processed in parallel with AVX2, NEON or scalar kernels,
+ * depending on the CPU.
+ * @return Image of the type CV_32F with the size of img.
+ */
+cv::Mat computeSaddleResponse(const cv::Mat& img);
+
+/**
+ * Searches the inner corners of a chessboard with the saddle point response instead of the quad
+ * detection of cv::findChessboardCorners(). The local maxima of the response which have the
+ * intensity profile of a chessboard corner are connected to a grid, starting at the strongest
+ * corners. The corners are returned row by row like the corners of cv::findChessboardCorners()
+ * and are only accurate to about a pixel, so they should be refined with cv::cornerSubPix().
+ * @return True if a grid with patternSize corners was found.
+ */
+bool findChessboardCornersSaddle(
+    const cv::Mat& img, const cv::Size2i& patternSize, std::vector<cv::Point2f>& corners);
+
+} // namespace libba
+
+#endif /* SADDLEPOINTDETECTOR_H_ */
@@ -0,0 +1,28 @@
+/*
+ * ViewSelection.h
+ *
+ *  Created on: 18.10.2026
+ */
+
+#ifndef VIEWSELECTION_H_
+#define VIEWSELECTION_H_
+
+#include <opencv2/core.hpp>
+#include <vector>
+
+namespace libba
+{
+/**
+ * Greedily selects up to maxViews views which cover the image as completely as possible and show
+ * the pattern in poses which differ as much as possible. The pose of a view is described by the
+ * homography between the pattern plane and the image, so no intrinsics are needed. Returns the
+ * indices of the selected views in ascending order, or all indices if there are at most maxViews
+ * views.
+ */
+std::vector<size_t> selectViews(const std::vector<std::vector<cv::Point2f> >& imagePoints,
+    const std::vector<std::vector<cv::Point3f> >& objectPoints, const cv::Size2i& imageSize,
+    const size_t maxViews);
+
+} // namespace libba
+
+#endif /* VIEWSELECTION_H_ */
@@ -8,8 +8,11 @@
 #ifndef UTILS_H_
 #define UTILS_H_
 
+#include <atomic>
+#include <functional>
 #include <opencv2/opencv.hpp>
 #include <regex>
+#include <string>
 #include <vector>
 
 namespace libba
@@ -20,6 +23,49 @@ namespace libba
 std::vector<std::string> readFilesFromDir(
     const std::string& dirPath, const std::regex& extensionFilter);
 
+struct DirectoryScanOptions
+{
+    /**
+     * If set to true the subdirectories are searched too.
+     */
+    bool recursive = true;
+
+    /**
+     * Number of threads which read directories in parallel. More than one thread mainly helps on
+     * network file systems where reading a directory has a high latency.
+     */
+    int numThreads = 1;
+
+    /**
+     * Number of files which are collected before they are passed to the batch function.
+     */
+    size_t batchSize = 256;
+};
+
+/**
+ * Searches a directory for files with one of the given extensions (e.g. ".png", compared case
+ * insensitive) and passes the found files in batches to batchFunc while the search is running.
+ * batchFunc is called from the scanning threads, but never by two threads at the same time.
+ * The search ends early if stopRequested is set to true. Returns the number of found files.
+ */
+size_t scanDirectory(const std::string& dirPath, const std::vector<std::string>& extensions,
+    const std::function<void(std::vector<std::string>&&)>& batchFunc,
+    const DirectoryScanOptions& options = DirectoryScanOptions(),
+    const std::atomic<bool>* stopRequested = nullptr);
+
+/**
+ * Reads a whole file into buffer. The buffer keeps its capacity, so reading files of similar
+ * size into the same buffer does not allocate memory. Members of archives are copied from the
+ * mapped archive. Returns false if the file can not be read.
+ */
+bool readFileInto(const std::string& filePath, std::vector<uchar>& buffer);
+
+/**
+ * Reads an image like cv::imread(). The path can also be the virtual path of a member of a tar or
+ * zip archive, see ImageArchive. Returns an empty matrix if the image can not be read.
+ */
+cv::Mat readImage(const std::string& filePath, const int flags = cv::IMREAD_COLOR);
+
 /**
  * Converts a cv::Mat to html code which can be displayed in a QLabel or a webpage.
  */
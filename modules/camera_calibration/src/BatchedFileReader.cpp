@@ -0,0 +1,604 @@
+/*
+ * BatchedFileReader.cpp
+ *
+ *  Created on: 18.10.2026
+ */
+
+#include "camera_calibration/BatchedFileReader.h"
+#include "camera_calibration/ImageArchive.h"
+#include "camera_calibration/utils.h"
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdint>
+#include <fcntl.h>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+#ifdef CAMCALIB_HAVE_LIBURING
+#include <liburing.h>
+#endif
+
+namespace libba
+{
+namespace
+{
+/**
+ * Largest read which is submitted at once, io_uring takes the length as 32 bit value.
+ */
+constexpr size_t maxReadSize = size_t(1) << 30;
+
+/**
+ * Asks the kernel to load a file into the page cache in the background.
+ */
+void adviseWillNeed(const std::string& filePath)
+{
+    const int fd = ::open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return;
+
+#if defined(POSIX_FADV_WILLNEED)
+    ::posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+#elif defined(F_RDADVISE)
+    struct stat fileStatus;
+    if (::fstat(fd, &fileStatus) == 0)
+    {
+        struct radvisory advice;
+        advice.ra_offset = 0;
+        advice.ra_count = static_cast<int>(std::min<off_t>(fileStatus.st_size, INT32_MAX));
+        ::fcntl(fd, F_RDADVISE, &advice);
+    }
+#endif
+    ::close(fd);
+}
+
+/**
+ * A read slot for one file of the read window. The slot of file i is i % readAhead.
+ */
+struct Slot
+{
+    std::vector<unsigned char> data;
+
+    /**
+     * The file which is read into the slot.
+     */
+    size_t fileIdx = 0;
+
+    /**
+     * Set to true when the read of fileIdx is finished.
+     */
+    bool done = false;
+    bool ok = false;
+
+    // state of an io_uring read
+    int fd = -1;
+    size_t offset = 0;
+
+    /**
+     * True while a read into data is submitted and its completion was not reaped yet.
+     */
+    bool reading = false;
+};
+} // namespace
+
+/**
+ * Reads the files of the window [released, released + readAhead) into their slots.
+ */
+class BatchedFileReader::Backend
+{
+public:
+    Backend(const std::vector<std::string>& filePaths, const size_t readAhead)
+        : filePaths(filePaths)
+        , slots(readAhead)
+    {
+    }
+    virtual ~Backend() = default;
+
+    /**
+     * Blocks until the file is read and returns its slot.
+     */
+    virtual Slot& wait(const size_t fileIdx) = 0;
+
+    /**
+     * Returns the slot of the file after the consumer took its data, so that a later file can be
+     * read into it.
+     */
+    virtual void release(const size_t fileIdx) = 0;
+
+    virtual bool usesIoUring() const = 0;
+
+protected:
+    /**
+     * Hints the kernel to read the file after the read window of fileIdx.
+     */
+    void adviseAfterWindow(const size_t fileIdx) const
+    {
+        if (fileIdx + slots.size() < filePaths.size())
+            adviseWillNeed(filePaths[fileIdx + slots.size()]);
+    }
+
+    std::vector<std::string> filePaths;
+    std::vector<Slot> slots;
+};
+
+/**
+ * Portable backend, a few threads read the files of the window with blocking reads.
+ */
+class BatchedFileReader::ThreadPoolBackend : public BatchedFileReader::Backend
+{
+public:
+    ThreadPoolBackend(
+        const std::vector<std::string>& filePaths, const size_t readAhead, const int numThreads)
+        : Backend(filePaths, readAhead)
+        , nextToRead(0)
+        , released(0)
+        , stopping(false)
+    {
+        const size_t threadCount
+            = std::min<size_t>(std::max(numThreads, 1), std::max<size_t>(filePaths.size(), 1));
+        for (size_t i = 0; i < threadCount; ++i)
+            threads.emplace_back(&ThreadPoolBackend::readFiles, this);
+    }
+
+    ~ThreadPoolBackend() override
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        condition.notify_all();
+        for (auto& thread : threads)
+            thread.join();
+    }
+
+    Slot& wait(const size_t fileIdx) override
+    {
+        Slot& slot = slots[fileIdx % slots.size()];
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, [&slot, fileIdx] { return slot.done && slot.fileIdx == fileIdx; });
+        return slot;
+    }
+
+    void release(const size_t fileIdx) override
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            slots[fileIdx % slots.size()].done = false;
+            released = fileIdx + 1;
+        }
+        condition.notify_all();
+    }
+
+    bool usesIoUring() const override
+    {
+        return false;
+    }
+
+protected:
+    void readFiles()
+    {
+        while (true)
+        {
+            size_t fileIdx;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                condition.wait(lock, [this] {
+                    return stopping
+                        || (nextToRead < filePaths.size() && nextToRead < released + slots.size());
+                });
+                if (stopping)
+                    return;
+                fileIdx = nextToRead++;
+            }
+
+            // the slot is not used by the consumer until it is marked as done
+            adviseAfterWindow(fileIdx);
+            Slot& slot = slots[fileIdx % slots.size()];
+            const bool ok = readFileInto(filePaths[fileIdx], slot.data);
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                slot.fileIdx = fileIdx;
+                slot.ok = ok;
+                slot.done = true;
+            }
+            condition.notify_all();
+        }
+    }
+
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable condition;
+
+    /**
+     * The next file which is read by a thread.
+     */
+    size_t nextToRead;
+
+    /**
+     * Number of files which were returned to the consumer.
+     */
+    size_t released;
+    bool stopping;
+};
+
+#ifdef CAMCALIB_HAVE_LIBURING
+/**
+ * Submits the reads of the whole window with one system call and collects the completions in
+ * the thread of the consumer, so no additional threads are needed. Files are opened and their
+ * size is queried with blocking calls, only the reads are asynchronous.
+ */
+class BatchedFileReader::IoUringBackend : public BatchedFileReader::Backend
+{
+public:
+    IoUringBackend(const std::vector<std::string>& filePaths, const size_t readAhead)
+        : Backend(filePaths, readAhead)
+        , nextToRead(0)
+        , released(0)
+        , inFlight(0)
+    {
+        const int result = io_uring_queue_init(static_cast<unsigned>(readAhead), &ring, 0);
+        if (result < 0)
+            throw std::runtime_error("io_uring is not available.");
+
+        submitWindow();
+    }
+
+    ~IoUringBackend() override
+    {
+        // The kernel writes into the buffers until the reads are completed. If the completions
+        // can not be reaped, the buffers of the reads in flight are leaked instead of freed.
+        while (inFlight > 0)
+        {
+            if (!completeOne())
+            {
+                auto* buffersInFlight = new std::vector<std::vector<unsigned char> >();
+                for (auto& slot : slots)
+                    if (slot.reading)
+                        buffersInFlight->push_back(std::move(slot.data));
+                for (auto& read : abandonedReads)
+                    buffersInFlight->push_back(std::move(read.data));
+                break;
+            }
+        }
+        for (auto& slot : slots)
+            closeFile(slot);
+        io_uring_queue_exit(&ring);
+    }
+
+    Slot& wait(const size_t fileIdx) override
+    {
+        Slot& slot = slots[fileIdx % slots.size()];
+        while (!(slot.done && slot.fileIdx == fileIdx))
+        {
+            if (!completeOne())
+                recoverSlot(slot);
+        }
+        return slot;
+    }
+
+    void release(const size_t fileIdx) override
+    {
+        slots[fileIdx % slots.size()].done = false;
+        released = fileIdx + 1;
+        submitWindow();
+    }
+
+    bool usesIoUring() const override
+    {
+        return true;
+    }
+
+protected:
+    /**
+     * Queues the reads of all files of the window which are not read yet and submits them.
+     */
+    void submitWindow()
+    {
+        bool queued = false;
+        while (nextToRead < filePaths.size() && nextToRead < released + slots.size())
+        {
+            const size_t fileIdx = nextToRead++;
+            adviseAfterWindow(fileIdx);
+
+            Slot& slot = slots[fileIdx % slots.size()];
+            slot.fileIdx = fileIdx;
+            slot.offset = 0;
+
+            // members of archives are copied from the mapped archive
+            if (isArchiveMemberPath(filePaths[fileIdx]))
+            {
+                finish(slot, readFileInto(filePaths[fileIdx], slot.data));
+                continue;
+            }
+
+            slot.fd = ::open(filePaths[fileIdx].c_str(), O_RDONLY | O_CLOEXEC);
+            struct stat fileStatus;
+            if (slot.fd < 0 || ::fstat(slot.fd, &fileStatus) != 0)
+            {
+                closeFile(slot);
+                finish(slot, false);
+                continue;
+            }
+
+            slot.data.resize(static_cast<size_t>(fileStatus.st_size));
+            if (slot.data.empty())
+            {
+                closeFile(slot);
+                finish(slot, true);
+                continue;
+            }
+            queued = queueRead(slot) || queued;
+        }
+        if (queued)
+            io_uring_submit(&ring);
+    }
+
+    /**
+     * Queues the read of the remaining bytes of the file of the slot.
+     */
+    bool queueRead(Slot& slot)
+    {
+        io_uring_sqe* sqe = io_uring_get_sqe(&ring);
+        if (sqe == nullptr)
+        {
+            closeFile(slot);
+            finish(slot, false);
+            return false;
+        }
+
+        const size_t length = std::min(slot.data.size() - slot.offset, maxReadSize);
+        io_uring_prep_read(sqe, slot.fd, slot.data.data() + slot.offset,
+            static_cast<unsigned>(length), slot.offset);
+        io_uring_sqe_set_data(sqe, userData(slot.fileIdx));
+        slot.reading = true;
+        ++inFlight;
+        return true;
+    }
+
+    /**
+     * Called if waiting for a completion failed. The read of the slot is cancelled and its
+     * completion is reaped before the slot is handed out. If that fails as well, the buffer of
+     * the read is kept until its completion arrives and the file is read again synchronously
+     * into a new buffer.
+     */
+    void recoverSlot(Slot& slot)
+    {
+        if (slot.reading && cancelRead(slot))
+        {
+            while (slot.reading && completeOne())
+            {
+            }
+        }
+
+        if (slot.reading)
+        {
+            abandonedReads.push_back(AbandonedRead { slot.fileIdx, std::move(slot.data) });
+            slot.data = std::vector<unsigned char>();
+            slot.reading = false;
+        }
+        else if (slot.done && slot.ok)
+            return;
+
+        closeFile(slot);
+        finish(slot, readFileInto(filePaths[slot.fileIdx], slot.data));
+    }
+
+    /**
+     * Submits the cancellation of the read of the slot. Its completion is not counted as in
+     * flight, because it does not use a buffer.
+     */
+    bool cancelRead(const Slot& slot)
+    {
+        io_uring_sqe* sqe = io_uring_get_sqe(&ring);
+        if (sqe == nullptr)
+            return false;
+
+        io_uring_prep_cancel(sqe, userData(slot.fileIdx), 0);
+        io_uring_sqe_set_data(sqe, userData(cancelFileIdx));
+        return io_uring_submit(&ring) >= 0;
+    }
+
+    /**
+     * Waits for the next completed read and handles it. Returns false if waiting failed.
+     */
+    bool completeOne()
+    {
+        io_uring_cqe* cqe = nullptr;
+        int result = io_uring_wait_cqe(&ring, &cqe);
+        while (result == -EINTR)
+            result = io_uring_wait_cqe(&ring, &cqe);
+        if (result < 0)
+            return false;
+
+        const size_t fileIdx = reinterpret_cast<uintptr_t>(io_uring_cqe_get_data(cqe));
+        const int bytesRead = cqe->res;
+        io_uring_cqe_seen(&ring, cqe);
+        if (fileIdx == cancelFileIdx)
+            return true;
+        --inFlight;
+
+        // the buffer of an abandoned read is only freed when the kernel is done with it
+        Slot& slot = slots[fileIdx % slots.size()];
+        if (!slot.reading || slot.fileIdx != fileIdx)
+        {
+            abandonedReads.erase(std::remove_if(abandonedReads.begin(), abandonedReads.end(),
+                                     [fileIdx](const AbandonedRead& read) {
+                                         return read.fileIdx == fileIdx;
+                                     }),
+                abandonedReads.end());
+            return true;
+        }
+        slot.reading = false;
+
+        if (bytesRead == -EINTR || bytesRead == -EAGAIN)
+        {
+            if (queueRead(slot))
+                io_uring_submit(&ring);
+            return true;
+        }
+        if (bytesRead <= 0)
+        {
+            // an error or the file became shorter since it was opened
+            slot.data.resize(slot.offset);
+            closeFile(slot);
+            finish(slot, false);
+            return true;
+        }
+
+        slot.offset += static_cast<size_t>(bytesRead);
+        if (slot.offset < slot.data.size())
+        {
+            // short read, the rest of the file is requested again
+            if (queueRead(slot))
+                io_uring_submit(&ring);
+            return true;
+        }
+
+        closeFile(slot);
+        finish(slot, true);
+        return true;
+    }
+
+    static void* userData(const size_t fileIdx)
+    {
+        return reinterpret_cast<void*>(static_cast<uintptr_t>(fileIdx));
+    }
+
+    static void closeFile(Slot& slot)
+    {
+        if (slot.fd >= 0)
+            ::close(slot.fd);
+        slot.fd = -1;
+    }
+
+    static void finish(Slot& slot, const bool ok)
+    {
+        slot.ok = ok;
+        slot.done = true;
+    }
+
+    io_uring ring;
+
+    /**
+     * The next file which is submitted.
+     */
+    size_t nextToRead;
+
+    /**
+     * Number of files which were returned to the consumer.
+     */
+    size_t released;
+
+    /**
+     * Number of submitted reads which are not completed.
+     */
+    size_t inFlight;
+
+    /**
+     * A read whose slot was read again synchronously, see recoverSlot().
+     */
+    struct AbandonedRead
+    {
+        size_t fileIdx;
+        std::vector<unsigned char> data;
+    };
+    std::vector<AbandonedRead> abandonedReads;
+
+    /**
+     * The user data of the completions of cancellations.
+     */
+    static constexpr size_t cancelFileIdx = std::numeric_limits<size_t>::max();
+};
+#endif
+
+double BatchedFileReader::Statistics::megabytesPerSecond() const
+{
+    return seconds > 0 ? bytes / (1e6 * seconds) : 0.0;
+}
+//-------------------------------------------------------------------------------------------------
+BatchedFileReader::BatchedFileReader(const std::vector<std::string>& filePaths)
+    : BatchedFileReader(filePaths, Options())
+{
+}
+//-------------------------------------------------------------------------------------------------
+BatchedFileReader::BatchedFileReader(
+    const std::vector<std::string>& filePaths, const Options& options)
+    : numFiles(filePaths.size())
+    , nextFile(0)
+    , startTime(std::chrono::steady_clock::now())
+{
+    const size_t readAhead = std::max<size_t>(options.readAhead, 1);
+
+#ifdef CAMCALIB_HAVE_LIBURING
+    if (options.useIoUring)
+    {
+        try
+        {
+            backend = std::make_unique<IoUringBackend>(filePaths, readAhead);
+        }
+        catch (const std::runtime_error&)
+        {
+            // e.g. disabled by the kernel, the thread pool is used instead
+        }
+    }
+#endif
+
+    if (!backend)
+        backend = std::make_unique<ThreadPoolBackend>(filePaths, readAhead, options.numThreads);
+}
+//-------------------------------------------------------------------------------------------------
+BatchedFileReader::~BatchedFileReader() = default;
+//-------------------------------------------------------------------------------------------------
+bool BatchedFileReader::readNext(std::vector<unsigned char>& data)
+{
+    if (!hasNext())
+        return false;
+
+    const auto waitStart = std::chrono::steady_clock::now();
+    Slot& slot = backend->wait(nextFile);
+    const auto waitEnd = std::chrono::steady_clock::now();
+
+    // the buffer of the caller is used for a later file
+    data.swap(slot.data);
+    const bool ok = slot.ok;
+    backend->release(nextFile);
+    ++nextFile;
+
+    statistics.files++;
+    if (ok)
+        statistics.bytes += data.size();
+    statistics.waitSeconds += std::chrono::duration<double>(waitEnd - waitStart).count();
+    statistics.seconds = std::chrono::duration<double>(waitEnd - startTime).count();
+    return ok;
+}
+//-------------------------------------------------------------------------------------------------
+bool BatchedFileReader::hasNext() const
+{
+    return nextFile < numFiles;
+}
+//-------------------------------------------------------------------------------------------------
+bool BatchedFileReader::usesIoUring() const
+{
+    return backend->usesIoUring();
+}
+//-------------------------------------------------------------------------------------------------
+BatchedFileReader::Statistics BatchedFileReader::getStatistics() const
+{
+    return statistics;
+}
+//-------------------------------------------------------------------------------------------------
+bool BatchedFileReader::isIoUringSupported()
+{
+#ifdef CAMCALIB_HAVE_LIBURING
+    return true;
+#else
+    return false;
+#endif
+}
+
+} // namespace libba
@@ -0,0 +1,366 @@
+/*
+ * BcalFile.cpp
+ *
+ *  Created on: 18.10.2026
+ */
+
+#include "camera_calibration/BcalFile.h"
+#include "camera_calibration/CalibrationPattern.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <opencv2/calib3d.hpp>
+#include <stdexcept>
+
+namespace libba
+{
+namespace
+{
+/**
+ * The structs are written as they are in memory, which matches the file format only on little
+ * endian systems.
+ */
+bool isLittleEndian()
+{
+    const uint16_t value = 1;
+    unsigned char firstByte;
+    std::memcpy(&firstByte, &value, 1);
+    return firstByte == 1;
+}
+//-------------------------------------------------------------------------------------------------
+uint64_t alignUp(const uint64_t value, const uint64_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+//-------------------------------------------------------------------------------------------------
+/**
+ * Returns true if count elements of elementSize bytes at offset are inside of the file and the
+ * offset is aligned.
+ */
+bool isInside(const uint64_t offset, const uint64_t count, const size_t elementSize,
+    const size_t alignment, const size_t fileSize)
+{
+    return offset % alignment == 0 && offset <= fileSize
+        && count <= (fileSize - offset) / elementSize;
+}
+//-------------------------------------------------------------------------------------------------
+std::shared_ptr<const CalibrationPattern> createPattern(const BcalHeader& header)
+{
+    const cv::Size2i size(header.patternWidth, header.patternHeight);
+    switch (static_cast<CalibrationPattern::Type>(header.patternType))
+    {
+    case CalibrationPattern::Type::Chessboard:
+        return std::make_shared<ChessboardPattern>(size, header.patternSpacing);
+    case CalibrationPattern::Type::SymmetricCircleGrid:
+        return std::make_shared<CircleGridPattern>(size, header.patternSpacing, false);
+    case CalibrationPattern::Type::AsymmetricCircleGrid:
+        return std::make_shared<CircleGridPattern>(size, header.patternSpacing, true);
+    case CalibrationPattern::Type::ChArUco:
+        // the points of a ChArUco board are the inner corners of its squares
+        if (!CharucoPattern::isSupported())
+            return std::make_shared<ChessboardPattern>(size, header.patternSpacing);
+        return std::make_shared<CharucoPattern>(size + cv::Size2i(1, 1), header.patternSpacing,
+            header.markerWidth, header.dictionaryId);
+    }
+    throw std::runtime_error("Unknown pattern type in the .bcal file.");
+}
+} // namespace
+//-------------------------------------------------------------------------------------------------
+BcalView makeBcalView(const CameraCalibration::CalibImgInfo& info)
+{
+    BcalView view;
+    std::memset(&view, 0, sizeof(view));
+    for (int j = 0; j < 3; ++j)
+    {
+        view.rotation[j] = info.rotation[j];
+        view.translation[j] = info.translation[j];
+    }
+    view.perceptualHash = info.perceptualHash;
+    view.flags = (info.patternFound ? BcalPatternFound : 0)
+        | (info.usedForCalibration ? BcalUsedForCalibration : 0)
+        | (info.cornersTracked ? BcalCornersTracked : 0)
+        | (info.detectedInRoi ? BcalDetectedInRoi : 0)
+        | (info.detectionTimedOut ? BcalDetectionTimedOut : 0);
+    view.frameIndex = info.frameIndex;
+    view.reprojectionError = info.reprojectionError;
+    view.detectionTime = info.detectionTime;
+    view.sharpness = info.sharpness;
+    view.clippedRatio = info.clippedRatio;
+    view.skipReason = static_cast<uint16_t>(info.skipReason);
+    view.detectionStrategy = static_cast<uint16_t>(info.detectionStrategy);
+    return view;
+}
+//-------------------------------------------------------------------------------------------------
+void readBcalView(const BcalView& view, CameraCalibration::CalibImgInfo& info)
+{
+    info.patternFound = (view.flags & BcalPatternFound) != 0;
+    info.usedForCalibration = (view.flags & BcalUsedForCalibration) != 0;
+    info.cornersTracked = (view.flags & BcalCornersTracked) != 0;
+    info.detectedInRoi = (view.flags & BcalDetectedInRoi) != 0;
+    info.detectionTimedOut = (view.flags & BcalDetectionTimedOut) != 0;
+    info.frameIndex = view.frameIndex;
+    info.reprojectionError = view.reprojectionError;
+    info.detectionTime = view.detectionTime;
+    info.sharpness = view.sharpness;
+    info.clippedRatio = view.clippedRatio;
+    info.skipReason = static_cast<CameraCalibration::SkipReason>(view.skipReason);
+    info.detectionStrategy
+        = static_cast<CameraCalibration::DetectionStrategy>(view.detectionStrategy);
+    info.perceptualHash = view.perceptualHash;
+    info.rotation = cv::Vec3d(view.rotation[0], view.rotation[1], view.rotation[2]);
+    info.translation = cv::Vec3d(view.translation[0], view.translation[1], view.translation[2]);
+}
+//-------------------------------------------------------------------------------------------------
+bool computeResiduals(const CameraCalibration::CalibrationResult& result,
+    const CameraCalibration::CalibImgInfo& info, std::vector<cv::Point2f>& residuals)
+{
+    residuals.clear();
+
+    // the pose of a view is known if its pattern was found
+    const std::vector<cv::Point2f>& corners = info.boardCornersImg;
+    if (!info.patternFound || corners.empty() || info.pointIds.size() != corners.size()
+        || !result.pattern || result.cameraMatrix.empty())
+        return false;
+
+    std::vector<cv::Point3f> objectPoints;
+    result.pattern->getObjectPoints(info.pointIds, objectPoints);
+    cv::projectPoints(objectPoints, info.rotation, info.translation, result.cameraMatrix,
+        result.distCoeffs, residuals);
+    for (size_t i = 0; i < corners.size(); ++i)
+    {
+        residuals[i].x -= corners[i].x;
+        residuals[i].y -= corners[i].y;
+    }
+    return true;
+}
+//-------------------------------------------------------------------------------------------------
+void writeBcalFile(
+    const std::string& filePath, const CameraCalibration::CalibrationResult& result)
+{
+    if (!isLittleEndian())
+        throw std::runtime_error(".bcal files can only be written on little endian systems.");
+    if (result.cameraMatrix.empty() || !result.pattern)
+        throw std::runtime_error("There are no camera parameters to save.");
+
+    BcalHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, bcalMagic, sizeof(bcalMagic));
+    header.version = bcalVersion;
+    header.headerSize = sizeof(BcalHeader);
+
+    for (int i = 0; i < 9; ++i)
+        header.cameraMatrix[i] = result.cameraMatrix.at<double>(i / 3, i % 3);
+
+    const size_t numDistortionCoefficients = std::min({ result.numDistortionCoefficents,
+        static_cast<size_t>(result.distCoeffs.total()), bcalMaxDistortionCoefficients });
+    for (size_t i = 0; i < numDistortionCoefficients; ++i)
+        header.distortion[i] = result.distCoeffs.at<double>(static_cast<int>(i));
+    header.numDistortionCoefficients = static_cast<uint32_t>(numDistortionCoefficients);
+    header.calibrationFlags = static_cast<uint32_t>(result.calibrationFlags);
+    header.imageWidth = result.imageSize.width;
+    header.imageHeight = result.imageSize.height;
+
+    header.patternType = static_cast<int32_t>(result.pattern->getType());
+    header.patternWidth = result.pattern->getSize().width;
+    header.patternHeight = result.pattern->getSize().height;
+    header.patternSpacing = result.pattern->getSpacing();
+    if (auto charuco = std::dynamic_pointer_cast<const CharucoPattern>(result.pattern))
+    {
+        header.markerWidth = charuco->getMarkerWidth();
+        header.dictionaryId = charuco->getDictionaryId();
+    }
+    header.reprojectionError = result.reprojectionError;
+    header.numUsedImages = static_cast<uint32_t>(result.numUsedImages);
+
+    std::vector<BcalView> views(result.images.size());
+    std::vector<BcalPoint> points;
+    std::string strings;
+    std::vector<cv::Point2f> residuals;
+    for (size_t i = 0; i < result.images.size(); ++i)
+    {
+        const CameraCalibration::CalibImgInfo& info = result.images[i];
+        BcalView& view = views[i];
+        view = makeBcalView(info);
+        view.firstPoint = points.size();
+        view.pathOffset = strings.size();
+        view.pathLength = static_cast<uint32_t>(info.filePath.size());
+        view.numPoints = static_cast<uint32_t>(info.boardCornersImg.size());
+        strings += info.filePath;
+
+        const std::vector<cv::Point2f>& corners = info.boardCornersImg;
+        const bool hasPose = computeResiduals(result, info, residuals);
+        for (size_t j = 0; j < corners.size(); ++j)
+        {
+            BcalPoint point;
+            point.x = corners[j].x;
+            point.y = corners[j].y;
+            point.id = j < info.pointIds.size() ? info.pointIds[j] : static_cast<int32_t>(j);
+            point.residualX = hasPose ? residuals[j].x : 0;
+            point.residualY = hasPose ? residuals[j].y : 0;
+            points.push_back(point);
+        }
+    }
+
+    header.numViews = views.size();
+    header.numPoints = points.size();
+    header.viewsOffset = alignUp(sizeof(BcalHeader), 8);
+    header.pointsOffset = header.viewsOffset + views.size() * sizeof(BcalView);
+    header.stringsOffset = header.pointsOffset + points.size() * sizeof(BcalPoint);
+    header.stringsSize = strings.size();
+    header.fileSize = header.stringsOffset + strings.size();
+
+    // the temporary file replaces the old file only after it was written completely
+    const std::string tempPath = filePath + ".tmp";
+    {
+        std::ofstream stream(tempPath, std::ios::binary | std::ios::trunc);
+        if (!stream.is_open())
+            throw std::runtime_error("Could not open the file: " + tempPath);
+
+        const std::vector<char> padding(header.viewsOffset - sizeof(BcalHeader), 0);
+        stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        stream.write(padding.data(), padding.size());
+        stream.write(reinterpret_cast<const char*>(views.data()), views.size() * sizeof(BcalView));
+        stream.write(
+            reinterpret_cast<const char*>(points.data()), points.size() * sizeof(BcalPoint));
+        stream.write(strings.data(), strings.size());
+        stream.close();
+        if (!stream)
+        {
+            std::filesystem::remove(tempPath);
+            throw std::runtime_error("Could not write the file: " + tempPath);
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(tempPath, filePath, error);
+    if (error)
+    {
+        std::filesystem::remove(tempPath);
+        throw std::runtime_error("Could not replace the file: " + filePath);
+    }
+}
+//-------------------------------------------------------------------------------------------------
+BcalFileView::BcalFileView(const std::string& filePath)
+    : file(filePath)
+    , header(nullptr)
+    , views(nullptr)
+    , points(nullptr)
+    , strings(nullptr)
+{
+    if (!isLittleEndian())
+        throw std::runtime_error(".bcal files can only be read on little endian systems.");
+
+    const unsigned char* data = file.getData();
+    const size_t size = file.getSize();
+    if (size < sizeof(BcalHeader))
+        throw std::runtime_error("The file is too small for a .bcal file: " + filePath);
+
+    // the mapping is page aligned, so the structs can be used in place
+    header = reinterpret_cast<const BcalHeader*>(data);
+    if (std::memcmp(header->magic, bcalMagic, sizeof(bcalMagic)) != 0)
+        throw std::runtime_error("Not a .bcal file: " + filePath);
+    if (header->version != bcalVersion)
+        throw std::runtime_error(
+            "Unsupported .bcal version " + std::to_string(header->version) + ": " + filePath);
+    if (header->headerSize < sizeof(BcalHeader) || header->fileSize != size)
+        throw std::runtime_error("The .bcal file is truncated or damaged: " + filePath);
+
+    if (!isInside(header->viewsOffset, header->numViews, sizeof(BcalView), 8, size)
+        || !isInside(header->pointsOffset, header->numPoints, sizeof(BcalPoint), 4, size)
+        || !isInside(header->stringsOffset, header->stringsSize, 1, 1, size)
+        || header->numDistortionCoefficients > bcalMaxDistortionCoefficients)
+        throw std::runtime_error("The .bcal file is damaged: " + filePath);
+
+    views = reinterpret_cast<const BcalView*>(data + header->viewsOffset);
+    points = reinterpret_cast<const BcalPoint*>(data + header->pointsOffset);
+    strings = reinterpret_cast<const char*>(data + header->stringsOffset);
+
+    // the accessors do not check the ranges of the views again
+    for (size_t i = 0; i < header->numViews; ++i)
+    {
+        const BcalView& view = views[i];
+        if (view.firstPoint > header->numPoints
+            || view.numPoints > header->numPoints - view.firstPoint
+            || view.pathOffset > header->stringsSize
+            || view.pathLength > header->stringsSize - view.pathOffset)
+            throw std::runtime_error("The .bcal file is damaged: " + filePath);
+    }
+
+    // the ids are used as indices into the object points of the pattern
+    if (header->patternWidth <= 0 || header->patternHeight <= 0
+        || (header->patternType == static_cast<int32_t>(CalibrationPattern::Type::ChArUco)
+            && (header->dictionaryId < 0
+                || header->dictionaryId > CharucoPattern::maxDictionaryId)))
+        throw std::runtime_error("The .bcal file has an invalid pattern: " + filePath);
+    const int64_t numPatternPoints = int64_t(header->patternWidth) * header->patternHeight;
+    for (size_t i = 0; i < header->numPoints; ++i)
+        if (points[i].id < 0 || points[i].id >= numPatternPoints)
+            throw std::runtime_error("The .bcal file contains an invalid point id: " + filePath);
+}
+//-------------------------------------------------------------------------------------------------
+const BcalHeader& BcalFileView::getHeader() const
+{
+    return *header;
+}
+//-------------------------------------------------------------------------------------------------
+size_t BcalFileView::getNumViews() const
+{
+    return header->numViews;
+}
+//-------------------------------------------------------------------------------------------------
+const BcalView& BcalFileView::getView(const size_t idx) const
+{
+    return views[idx];
+}
+//-------------------------------------------------------------------------------------------------
+const BcalPoint* BcalFileView::getPoints(const BcalView& view) const
+{
+    return points + view.firstPoint;
+}
+//-------------------------------------------------------------------------------------------------
+std::string BcalFileView::getFilePath(const BcalView& view) const
+{
+    return std::string(strings + view.pathOffset, view.pathLength);
+}
+//-------------------------------------------------------------------------------------------------
+CameraCalibration::CalibrationResult BcalFileView::toResult() const
+{
+    CameraCalibration::CalibrationResult result;
+    result.cameraMatrix = cv::Mat(3, 3, CV_64F);
+    for (int i = 0; i < 9; ++i)
+        result.cameraMatrix.at<double>(i / 3, i % 3) = header->cameraMatrix[i];
+
+    const int numDistortionCoefficients = static_cast<int>(header->numDistortionCoefficients);
+    result.distCoeffs = cv::Mat::zeros(numDistortionCoefficients, 1, CV_64F);
+    for (int i = 0; i < numDistortionCoefficients; ++i)
+        result.distCoeffs.at<double>(i) = header->distortion[i];
+    result.numDistortionCoefficents = header->numDistortionCoefficients;
+    result.calibrationFlags = static_cast<int>(header->calibrationFlags);
+    result.imageSize = cv::Size2i(header->imageWidth, header->imageHeight);
+    result.reprojectionError = header->reprojectionError;
+    result.pattern = createPattern(*header);
+    result.chessboardSize = result.pattern->getSize();
+    result.numUsedImages = header->numUsedImages;
+
+    result.images.resize(header->numViews);
+    for (size_t i = 0; i < header->numViews; ++i)
+    {
+        const BcalView& view = views[i];
+        CameraCalibration::CalibImgInfo& info = result.images[i];
+        info.filePath = getFilePath(view);
+        readBcalView(view, info);
+
+        const BcalPoint* viewPoints = getPoints(view);
+        info.boardCornersImg.resize(view.numPoints);
+        info.pointIds.resize(view.numPoints);
+        for (size_t j = 0; j < view.numPoints; ++j)
+        {
+            info.boardCornersImg[j] = cv::Point2f(viewPoints[j].x, viewPoints[j].y);
+            info.pointIds[j] = viewPoints[j].id;
+        }
+    }
+    return result;
+}
+
+} // namespace libba
@@ -0,0 +1,259 @@
+/*
+ * CalibrationJsonFile.cpp
+ *
+ *  Created on: 18.10.2026
+ */
+
+#include "camera_calibration/CalibrationJsonFile.h"
+#include "camera_calibration/BcalFile.h"
+#include "camera_calibration/JsonStreamWriter.h"
+#include "nlohmann/json.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+namespace libba
+{
+namespace
+{
+void writeView(JsonStreamWriter& writer, const CameraCalibration::CalibImgInfo& info,
+    const std::vector<cv::Point2f>& residuals)
+{
+    writer.startObject();
+    writer.key("file");
+    writer.string(info.filePath);
+    writer.key("frame_index");
+    writer.numberInteger(info.frameIndex);
+    writer.key("pattern_found");
+    writer.boolean(info.patternFound);
+    writer.key("used_for_calibration");
+    writer.boolean(info.usedForCalibration);
+    writer.key("reprojection_error");
+    writer.numberFloat(info.reprojectionError, 9);
+
+    writer.key("rotation");
+    writer.startArray();
+    for (int i = 0; i < 3; ++i)
+        writer.numberFloat(info.rotation[i]);
+    writer.endArray();
+
+    writer.key("translation");
+    writer.startArray();
+    for (int i = 0; i < 3; ++i)
+        writer.numberFloat(info.translation[i]);
+    writer.endArray();
+
+    writer.key("ids");
+    writer.startArray();
+    for (size_t i = 0; i < info.boardCornersImg.size(); ++i)
+        writer.numberInteger(i < info.pointIds.size() ? info.pointIds[i] : static_cast<int>(i));
+    writer.endArray();
+
+    // the points are floats, 9 digits restore them exactly
+    writer.key("corners");
+    writer.startArray();
+    for (const cv::Point2f& corner : info.boardCornersImg)
+    {
+        writer.startArray();
+        writer.numberFloat(corner.x, 9);
+        writer.numberFloat(corner.y, 9);
+        writer.endArray();
+    }
+    writer.endArray();
+
+    writer.key("residuals");
+    writer.startArray();
+    for (const cv::Point2f& residual : residuals)
+    {
+        writer.startArray();
+        writer.numberFloat(residual.x, 9);
+        writer.numberFloat(residual.y, 9);
+        writer.endArray();
+    }
+    writer.endArray();
+    writer.endObject();
+}
+//-------------------------------------------------------------------------------------------------
+cv::Point2f readPoint(const nlohmann::json& pointJson)
+{
+    return cv::Point2f(pointJson.at(0).get<float>(), pointJson.at(1).get<float>());
+}
+//-------------------------------------------------------------------------------------------------
+void readView(const nlohmann::json& viewJson, CameraCalibration::CalibImgInfo& info,
+    std::vector<cv::Point2f>& residuals)
+{
+    info.filePath = viewJson.at("file").get<std::string>();
+    info.frameIndex = viewJson.at("frame_index").get<int>();
+    info.patternFound = viewJson.at("pattern_found").get<bool>();
+    info.usedForCalibration = viewJson.at("used_for_calibration").get<bool>();
+
+    // NaN and infinity were written as null
+    const nlohmann::json& errorJson = viewJson.at("reprojection_error");
+    info.reprojectionError
+        = errorJson.is_null() ? jsonInvalidReprojectionError : errorJson.get<float>();
+
+    const nlohmann::json& rotationJson = viewJson.at("rotation");
+    const nlohmann::json& translationJson = viewJson.at("translation");
+    for (int i = 0; i < 3; ++i)
+    {
+        info.rotation[i] = rotationJson.at(i).get<double>();
+        info.translation[i] = translationJson.at(i).get<double>();
+    }
+
+    const nlohmann::json& idsJson = viewJson.at("ids");
+    const nlohmann::json& cornersJson = viewJson.at("corners");
+    const nlohmann::json& residualsJson = viewJson.at("residuals");
+    if (idsJson.size() != cornersJson.size()
+        || (!residualsJson.empty() && residualsJson.size() != cornersJson.size()))
+        throw std::out_of_range("The number of ids, corners and residuals differs.");
+
+    info.pointIds.resize(idsJson.size());
+    info.boardCornersImg.resize(cornersJson.size());
+    residuals.resize(residualsJson.size());
+    for (size_t i = 0; i < cornersJson.size(); ++i)
+    {
+        info.pointIds[i] = idsJson[i].get<int>();
+        info.boardCornersImg[i] = readPoint(cornersJson[i]);
+    }
+    for (size_t i = 0; i < residualsJson.size(); ++i)
+        residuals[i] = readPoint(residualsJson[i]);
+}
+} // namespace
+//-------------------------------------------------------------------------------------------------
+void writeCalibrationJsonFile(
+    const std::string& filePath, const CameraCalibration::CalibrationResult& result)
+{
+    namespace fs = std::filesystem;
+
+    if (result.cameraMatrix.empty())
+        throw std::runtime_error("There are no camera parameters to save.");
+
+    const std::string tempPath = filePath + ".tmp";
+    {
+        std::ofstream stream(tempPath, std::ios::trunc);
+        if (!stream.is_open())
+            throw std::runtime_error("Could not open the file: " + tempPath);
+
+        JsonStreamWriter writer(stream);
+        writer.startObject();
+        writer.key("fx");
+        writer.numberFloat(result.cameraMatrix.at<double>(0, 0));
+        writer.key("fy");
+        writer.numberFloat(result.cameraMatrix.at<double>(1, 1));
+        writer.key("cx");
+        writer.numberFloat(result.cameraMatrix.at<double>(0, 2));
+        writer.key("cy");
+        writer.numberFloat(result.cameraMatrix.at<double>(1, 2));
+        writer.key("horizontal_resolution");
+        writer.numberInteger(result.imageSize.width);
+        writer.key("vertical_resolution");
+        writer.numberInteger(result.imageSize.height);
+
+        writer.key("distortion_coefficients");
+        writer.startArray();
+        const size_t numDistortionCoefficients = std::min(
+            result.numDistortionCoefficents, static_cast<size_t>(result.distCoeffs.total()));
+        for (size_t i = 0; i < numDistortionCoefficients; ++i)
+            writer.numberFloat(result.distCoeffs.at<double>(static_cast<int>(i)));
+        writer.endArray();
+
+        writer.key("reprojection_error");
+        writer.numberFloat(result.reprojectionError, 9);
+        writer.key("calibration_flags");
+        writer.numberInteger(result.calibrationFlags);
+        writer.key("num_used_images");
+        writer.numberInteger(static_cast<int64_t>(result.numUsedImages));
+
+        // one line per view, so a reader which reads line by line buffers only one view
+        std::vector<cv::Point2f> residuals;
+        writer.key("views");
+        writer.startArray();
+        for (const CameraCalibration::CalibImgInfo& info : result.images)
+        {
+            computeResiduals(result, info, residuals);
+            writer.lineBreak();
+            writeView(writer, info, residuals);
+        }
+        writer.lineBreak();
+        writer.endArray();
+        writer.endObject();
+        writer.lineBreak();
+
+        stream.close();
+        if (!stream)
+        {
+            fs::remove(tempPath);
+            throw std::runtime_error("Could not write the file: " + tempPath);
+        }
+    }
+
+    std::error_code error;
+    fs::rename(tempPath, filePath, error);
+    if (error)
+    {
+        fs::remove(tempPath);
+        throw std::runtime_error("Could not replace the file: " + filePath);
+    }
+}
+//-------------------------------------------------------------------------------------------------
+CameraCalibration::CalibrationResult readCalibrationJsonFile(
+    const std::string& filePath, const JsonViewFunc& viewFunc)
+{
+    std::ifstream stream(filePath);
+    if (!stream.is_open())
+        throw std::runtime_error("Could not open the file: " + filePath);
+
+    using ParseEvent = nlohmann::json::parse_event_t;
+    CameraCalibration::CalibrationResult result;
+    try
+    {
+        // the views are objects at depth 2 below "views", each one is handed to viewFunc and
+        // then discarded instead of being added to the document
+        bool inViews = false;
+        CameraCalibration::CalibImgInfo info;
+        std::vector<cv::Point2f> residuals;
+        const nlohmann::json camJson = nlohmann::json::parse(stream,
+            [&](int depth, ParseEvent event, nlohmann::json& parsed) {
+                if (depth == 1 && event == ParseEvent::key)
+                    inViews = parsed == "views";
+                else if (depth == 2 && event == ParseEvent::object_end && inViews)
+                {
+                    info = CameraCalibration::CalibImgInfo();
+                    readView(parsed, info, residuals);
+                    if (viewFunc)
+                        viewFunc(info, residuals);
+                    return false;
+                }
+                return true;
+            });
+
+        result.cameraMatrix = cv::Mat::eye(3, 3, CV_64F);
+        result.cameraMatrix.at<double>(0, 0) = camJson.at("fx").get<double>();
+        result.cameraMatrix.at<double>(1, 1) = camJson.at("fy").get<double>();
+        result.cameraMatrix.at<double>(0, 2) = camJson.at("cx").get<double>();
+        result.cameraMatrix.at<double>(1, 2) = camJson.at("cy").get<double>();
+        result.imageSize.width = camJson.at("horizontal_resolution").get<int>();
+        result.imageSize.height = camJson.at("vertical_resolution").get<int>();
+
+        const nlohmann::json& distortionJson = camJson.at("distortion_coefficients");
+        result.numDistortionCoefficents = distortionJson.size();
+        result.distCoeffs = cv::Mat::zeros(static_cast<int>(distortionJson.size()), 1, CV_64F);
+        for (size_t i = 0; i < distortionJson.size(); ++i)
+            result.distCoeffs.at<double>(static_cast<int>(i), 0) = distortionJson[i].get<double>();
+
+        const nlohmann::json& errorJson = camJson.at("reprojection_error");
+        result.reprojectionError
+            = errorJson.is_null() ? jsonInvalidReprojectionError : errorJson.get<float>();
+        result.calibrationFlags = camJson.at("calibration_flags").get<int>();
+        result.numUsedImages = camJson.at("num_used_images").get<size_t>();
+    }
+    catch (const std::logic_error& e)
+    {
+        // nlohmann::json reports syntax errors and missing or mistyped keys as std::logic_error
+        throw std::runtime_error("Damaged calibration file " + filePath + ": " + e.what());
+    }
+    return result;
+}
+
+} // namespace libba
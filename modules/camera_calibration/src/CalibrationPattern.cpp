@@ -0,0 +1,317 @@
+/*
+ * CalibrationPattern.cpp
+ *
+ *  Created on: 18.10.2026
+ */
+
+#include "camera_calibration/CalibrationPattern.h"
+#include <numeric>
+#include <opencv2/calib3d.hpp>
+#include <opencv2/imgproc.hpp>
+#include <stdexcept>
+#include <string>
+
+// OpenCV 4.7 moved the ChArUco detection from the contrib module aruco into objdetect
+#if __has_include(<opencv2/objdetect/charuco_detector.hpp>)
+#include <opencv2/objdetect/charuco_detector.hpp>
+#define CAMCALIB_HAVE_CHARUCO_DETECTOR
+#elif __has_include(<opencv2/aruco/charuco.hpp>)
+#include <opencv2/aruco/charuco.hpp>
+#define CAMCALIB_HAVE_ARUCO_CONTRIB
+#endif
+
+namespace libba
+{
+namespace
+{
+/**
+ * Minimum number of ChArUco corners of a view. Fewer corners do not constrain the pose well.
+ */
+constexpr size_t minCharucoCorners = 6;
+
+/**
+ * Radius in pixels of the points which are drawn for a partial view.
+ */
+constexpr int drawnPointRadius = 4;
+
+/**
+ * Returns the ids 0 to count - 1.
+ */
+std::vector<int> sequentialIds(const size_t count)
+{
+    std::vector<int> ids(count);
+    std::iota(ids.begin(), ids.end(), 0);
+    return ids;
+}
+} // namespace
+
+CalibrationPattern::CalibrationPattern(const cv::Size2i& size, const float spacing)
+    : size(size)
+    , spacing(spacing)
+{
+    if (size.width < 2 || size.height < 2)
+        throw std::runtime_error("A calibration pattern needs at least 2x2 points.");
+}
+//-------------------------------------------------------------------------------------------------
+bool CalibrationPattern::allowsPartialViews() const
+{
+    return false;
+}
+//-------------------------------------------------------------------------------------------------
+cv::Size2i CalibrationPattern::getSize() const
+{
+    return size;
+}
+//-------------------------------------------------------------------------------------------------
+float CalibrationPattern::getSpacing() const
+{
+    return spacing;
+}
+//-------------------------------------------------------------------------------------------------
+const std::vector<cv::Point3f>& CalibrationPattern::getObjectPoints() const
+{
+    return objectPoints;
+}
+//-------------------------------------------------------------------------------------------------
+void CalibrationPattern::getObjectPoints(
+    const std::vector<int>& pointIds, std::vector<cv::Point3f>& points) const
+{
+    points.clear();
+    for (const int id : pointIds)
+        points.push_back(objectPoints.at(id));
+}
+//-------------------------------------------------------------------------------------------------
+void CalibrationPattern::drawObservation(cv::Mat& img, const std::vector<cv::Point2f>& imagePoints,
+    const std::vector<int>& pointIds) const
+{
+    if (pointIds == sequentialIds(objectPoints.size()))
+    {
+        cv::drawChessboardCorners(img, size, imagePoints, true);
+        return;
+    }
+
+    const cv::Scalar color(0, 0, 255);
+    for (size_t i = 0; i < imagePoints.size() && i < pointIds.size(); ++i)
+    {
+        cv::circle(img, imagePoints[i], drawnPointRadius, color, 2);
+        cv::putText(img, std::to_string(pointIds[i]),
+            imagePoints[i] + cv::Point2f(drawnPointRadius, -drawnPointRadius),
+            cv::FONT_HERSHEY_SIMPLEX, 0.5, color);
+    }
+}
+//-------------------------------------------------------------------------------------------------
+ChessboardPattern::ChessboardPattern(const cv::Size2i& innerCorners, const float squareWidth)
+    : CalibrationPattern(innerCorners, squareWidth)
+{
+    for (int i = 0; i < size.height; ++i)
+        for (int j = 0; j < size.width; ++j)
+            objectPoints.emplace_back(float(j * spacing), float(i * spacing), 0);
+}
+//-------------------------------------------------------------------------------------------------
+CalibrationPattern::Type ChessboardPattern::getType() const
+{
+    return Type::Chessboard;
+}
+//-------------------------------------------------------------------------------------------------
+bool ChessboardPattern::detect(
+    const cv::Mat& img, std::vector<cv::Point2f>& imagePoints, std::vector<int>& pointIds) const
+{
+    if (!cv::findChessboardCorners(img, size, imagePoints,
+            cv::CALIB_CB_ADAPTIVE_THRESH | cv::CALIB_CB_FILTER_QUADS))
+        return false;
+
+    pointIds = sequentialIds(imagePoints.size());
+    return true;
+}
+//-------------------------------------------------------------------------------------------------
+bool ChessboardPattern::hasCorners() const
+{
+    return true;
+}
+//-------------------------------------------------------------------------------------------------
+std::shared_ptr<const CalibrationPattern> ChessboardPattern::withGeometry(
+    const cv::Size2i& newSize, const float newSpacing) const
+{
+    return std::make_shared<ChessboardPattern>(newSize, newSpacing);
+}
+//-------------------------------------------------------------------------------------------------
+CircleGridPattern::CircleGridPattern(
+    const cv::Size2i& circles, const float spacing, const bool asymmetric)
+    : CalibrationPattern(circles, spacing)
+    , asymmetric(asymmetric)
+{
+    for (int i = 0; i < size.height; ++i)
+        for (int j = 0; j < size.width; ++j)
+        {
+            const int column = asymmetric ? 2 * j + i % 2 : j;
+            objectPoints.emplace_back(float(column * spacing), float(i * spacing), 0);
+        }
+}
+//-------------------------------------------------------------------------------------------------
+CalibrationPattern::Type CircleGridPattern::getType() const
+{
+    return asymmetric ? Type::AsymmetricCircleGrid : Type::SymmetricCircleGrid;
+}
+//-------------------------------------------------------------------------------------------------
+bool CircleGridPattern::detect(
+    const cv::Mat& img, std::vector<cv::Point2f>& imagePoints, std::vector<int>& pointIds) const
+{
+    const int flags = asymmetric ? cv::CALIB_CB_ASYMMETRIC_GRID : cv::CALIB_CB_SYMMETRIC_GRID;
+    if (!cv::findCirclesGrid(img, size, imagePoints, flags))
+        return false;
+
+    pointIds = sequentialIds(imagePoints.size());
+    return true;
+}
+//-------------------------------------------------------------------------------------------------
+bool CircleGridPattern::hasCorners() const
+{
+    return false;
+}
+//-------------------------------------------------------------------------------------------------
+std::shared_ptr<const CalibrationPattern> CircleGridPattern::withGeometry(
+    const cv::Size2i& newSize, const float newSpacing) const
+{
+    return std::make_shared<CircleGridPattern>(newSize, newSpacing, asymmetric);
+}
+//-------------------------------------------------------------------------------------------------
+#if defined(CAMCALIB_HAVE_CHARUCO_DETECTOR)
+struct CharucoPattern::Detector
+{
+    Detector(const cv::Size2i& squares, const float squareWidth, const float markerWidth,
+        const int dictionaryId)
+        : board(squares, squareWidth, markerWidth,
+            cv::aruco::getPredefinedDictionary(dictionaryId))
+        , detector(board)
+    {
+    }
+
+    void detect(const cv::Mat& img, std::vector<cv::Point2f>& corners, std::vector<int>& ids) const
+    {
+        detector.detectBoard(img, corners, ids);
+    }
+
+    cv::aruco::CharucoBoard board;
+    cv::aruco::CharucoDetector detector;
+};
+#elif defined(CAMCALIB_HAVE_ARUCO_CONTRIB)
+struct CharucoPattern::Detector
+{
+    Detector(const cv::Size2i& squares, const float squareWidth, const float markerWidth,
+        const int dictionaryId)
+        : board(cv::aruco::CharucoBoard::create(squares.width, squares.height, squareWidth,
+            markerWidth, cv::aruco::getPredefinedDictionary(dictionaryId)))
+    {
+    }
+
+    void detect(const cv::Mat& img, std::vector<cv::Point2f>& corners, std::vector<int>& ids) const
+    {
+        std::vector<std::vector<cv::Point2f> > markerCorners;
+        std::vector<int> markerIds;
+        cv::aruco::detectMarkers(img, board->dictionary, markerCorners, markerIds);
+        if (markerIds.empty())
+            return;
+
+        cv::aruco::interpolateCornersCharuco(markerCorners, markerIds, img, board, corners, ids);
+    }
+
+    cv::Ptr<cv::aruco::CharucoBoard> board;
+};
+#endif
+//-------------------------------------------------------------------------------------------------
+CharucoPattern::CharucoPattern(const cv::Size2i& squares, const float squareWidth,
+    const float markerWidth, const int dictionaryId)
+    : CalibrationPattern(squares - cv::Size2i(1, 1), squareWidth)
+    , markerWidth(markerWidth)
+    , dictionaryId(dictionaryId)
+{
+    if (!isSupported())
+        throw std::runtime_error(
+            "ChArUco boards are not supported, OpenCV was built without the ArUco module.");
+    if (markerWidth <= 0 || markerWidth >= squareWidth)
+        throw std::runtime_error(
+            "The markers of a ChArUco board must be smaller than its squares.");
+    if (dictionaryId < 0 || dictionaryId > maxDictionaryId)
+        throw std::runtime_error("Unknown ArUco dictionary: " + std::to_string(dictionaryId));
+
+    // the inner corners start one square away from the border of the board
+    for (int i = 0; i < size.height; ++i)
+        for (int j = 0; j < size.width; ++j)
+            objectPoints.emplace_back(float((j + 1) * spacing), float((i + 1) * spacing), 0);
+
+#if defined(CAMCALIB_HAVE_CHARUCO_DETECTOR) || defined(CAMCALIB_HAVE_ARUCO_CONTRIB)
+    detector = std::make_shared<const Detector>(squares, squareWidth, markerWidth, dictionaryId);
+#endif
+}
+//-------------------------------------------------------------------------------------------------
+bool CharucoPattern::isSupported()
+{
+#if defined(CAMCALIB_HAVE_CHARUCO_DETECTOR) || defined(CAMCALIB_HAVE_ARUCO_CONTRIB)
+    return true;
+#else
+    return false;
+#endif
+}
+//-------------------------------------------------------------------------------------------------
+CalibrationPattern::Type CharucoPattern::getType() const
+{
+    return Type::ChArUco;
+}
+//-------------------------------------------------------------------------------------------------
+bool CharucoPattern::detect(
+    const cv::Mat& img, std::vector<cv::Point2f>& imagePoints, std::vector<int>& pointIds) const
+{
+    imagePoints.clear();
+    pointIds.clear();
+#if defined(CAMCALIB_HAVE_CHARUCO_DETECTOR) || defined(CAMCALIB_HAVE_ARUCO_CONTRIB)
+    detector->detect(img, imagePoints, pointIds);
+#else
+    (void)img;
+#endif
+    if (imagePoints.size() < minCharucoCorners || imagePoints.size() != pointIds.size())
+        return false;
+
+    // corners on a line, e.g. a row or a diagonal, do not define a plane, so the corners have to
+    // span an area on the board
+    const cv::Point2i first(pointIds[0] % size.width, pointIds[0] / size.width);
+    cv::Point2i direction(0, 0);
+    for (const int id : pointIds)
+    {
+        const cv::Point2i offset = cv::Point2i(id % size.width, id / size.width) - first;
+        if (direction == cv::Point2i(0, 0))
+            direction = offset;
+        else if (direction.cross(offset) != 0)
+            return true;
+    }
+    return false;
+}
+//-------------------------------------------------------------------------------------------------
+bool CharucoPattern::hasCorners() const
+{
+    return true;
+}
+//-------------------------------------------------------------------------------------------------
+bool CharucoPattern::allowsPartialViews() const
+{
+    return true;
+}
+//-------------------------------------------------------------------------------------------------
+std::shared_ptr<const CalibrationPattern> CharucoPattern::withGeometry(
+    const cv::Size2i& newSize, const float newSpacing) const
+{
+    // the markers keep their size relative to the squares
+    return std::make_shared<CharucoPattern>(newSize + cv::Size2i(1, 1), newSpacing,
+        markerWidth * newSpacing / spacing, dictionaryId);
+}
+//-------------------------------------------------------------------------------------------------
+float CharucoPattern::getMarkerWidth() const
+{
+    return markerWidth;
+}
+//-------------------------------------------------------------------------------------------------
+int CharucoPattern::getDictionaryId() const
+{
+    return dictionaryId;
+}
+
+} // namespace libba
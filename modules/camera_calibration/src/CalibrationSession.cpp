@@ -0,0 +1,117 @@
+/*
+ * CalibrationSession.cpp
+ *
+ *  Created on: 18.10.2026
+ */
+
+#include "camera_calibration/CalibrationSession.h"
+#include "nlohmann/json.hpp"
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+namespace libba
+{
+namespace
+{
+constexpr int sessionVersion = 1;
+} // namespace
+//-------------------------------------------------------------------------------------------------
+void saveSession(const std::string& filePath, const CalibrationSession& session,
+    const CameraCalibration& calibration)
+{
+    namespace fs = std::filesystem;
+
+    // the result is referenced by its file name, so the session can be moved with its result
+    const std::string resultPath = filePath + ".bcal";
+    const bool hasResult = calibration.getResult() != nullptr;
+    if (hasResult)
+        calibration.exportCameraParametersBinary(resultPath);
+
+    nlohmann::json sessionJson;
+    sessionJson["version"] = sessionVersion;
+    sessionJson["settings"] = session.settings;
+    sessionJson["result"]
+        = hasResult ? nlohmann::json(fs::path(resultPath).filename().string()) : nlohmann::json();
+
+    // an array per image instead of an object keeps large sessions small
+    nlohmann::json& images = sessionJson["images"] = nlohmann::json::array();
+    for (const CalibrationSession::Image& image : session.images)
+        images.push_back(nlohmann::json::array({ image.filePath, image.checked }));
+
+    // the old session is only replaced if the new one was written completely
+    const std::string tempPath = filePath + ".tmp";
+    {
+        std::ofstream stream(tempPath);
+        if (!stream.is_open())
+            throw std::runtime_error("Could not open the file: " + tempPath);
+        stream << sessionJson;
+        stream.close();
+        if (!stream)
+        {
+            fs::remove(tempPath);
+            throw std::runtime_error("Could not write the file: " + tempPath);
+        }
+    }
+
+    std::error_code error;
+    fs::rename(tempPath, filePath, error);
+    if (error)
+    {
+        fs::remove(tempPath);
+        throw std::runtime_error("Could not replace the file: " + filePath);
+    }
+
+    // an old result must not be loaded with the new session
+    if (!hasResult)
+        fs::remove(resultPath, error);
+}
+//-------------------------------------------------------------------------------------------------
+CalibrationSession loadSession(const std::string& filePath, CameraCalibration& calibration)
+{
+    namespace fs = std::filesystem;
+
+    std::ifstream stream(filePath);
+    if (!stream.is_open())
+        throw std::runtime_error("Could not open the session: " + filePath);
+
+    CalibrationSession session;
+    try
+    {
+        nlohmann::json sessionJson;
+        stream >> sessionJson;
+
+        const int version = sessionJson.at("version").get<int>();
+        if (version != sessionVersion)
+            throw std::runtime_error("Unsupported session version " + std::to_string(version)
+                + ": " + filePath);
+
+        const nlohmann::json& settings = sessionJson.at("settings");
+        for (auto it = settings.begin(); it != settings.end(); ++it)
+            session.settings[it.key()] = it.value().get<std::string>();
+
+        const nlohmann::json& images = sessionJson.at("images");
+        session.images.resize(images.size());
+        for (size_t i = 0; i < images.size(); ++i)
+        {
+            session.images[i].filePath = images[i].at(0).get<std::string>();
+            session.images[i].checked = images[i].at(1).get<bool>();
+        }
+
+        const nlohmann::json& result = sessionJson.at("result");
+        if (!result.is_null())
+        {
+            const fs::path resultPath
+                = fs::path(filePath).parent_path() / result.get<std::string>();
+            calibration.loadCameraParametersBinary(resultPath.string());
+        }
+    }
+    catch (const std::logic_error& e)
+    {
+        // the json library reports parse and type errors as std::logic_error
+        throw std::runtime_error("Damaged session " + filePath + ": " + e.what());
+    }
+    return session;
+}
+
+} // namespace libba
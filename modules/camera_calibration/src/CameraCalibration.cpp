@@ -6,141 +6,1279 @@
  */
 
 #include "camera_calibration/CameraCalibration.h"
+#include "camera_calibration/BcalFile.h"
+#include "camera_calibration/CalibrationJsonFile.h"
+#include "camera_calibration/DetectionJournal.h"
+#include "camera_calibration/ImageArchive.h"
+#include "camera_calibration/ImageHeader.h"
+#include "camera_calibration/ImageQuality.h"
+#include "camera_calibration/SaddlePointDetector.h"
+#include "camera_calibration/ViewSelection.h"
+#include "camera_calibration/utils.h"
 #include "nlohmann/json.hpp"
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cmath>
 #include <filesystem>
 #include <fstream>
+#include <future>
+#include <limits>
+#include <numeric>
 #include <opencv2/core.hpp>
+#include <sstream>
 #include <stdexcept>
+#include <thread>
 
 namespace libba
 {
+namespace
+{
+/**
+ * Maximum number of iterations of the solver and the number of iterations after which the
+ * interruptible solver checks for a stop request.
+ */
+constexpr int maxSolverIterations = 30;
+constexpr int solverIterationsPerStep = 5;
+
+/**
+ * Number of corners which are refined between two checks for a stop request.
+ */
+constexpr size_t refinementChunkSize = 32;
+
+/**
+ * Minimum number of corners of an image for which the chunks of the refinement are processed
+ * by several threads. For smaller boards the overhead of the threads outweighs the gain.
+ */
+constexpr size_t parallelRefinementMinCorners = 256;
+
+/**
+ * Maximum number of problems which are listed in the message of the exception thrown by
+ * calibrateCamera() if the validation of the images failed.
+ */
+constexpr size_t maxReportedProblems = 20;
+
+/**
+ * Maximum distance in pixels between a corner and its position after tracking it forward and
+ * backward.
+ */
+constexpr double maxTrackingError = 1.0;
+
+/**
+ * Minimum padding in pixels around the last board position for the detection in a region of
+ * interest.
+ */
+constexpr int minRoiPadding = 32;
+
+/**
+ * Maximum size in pixels of the longer side of the image on which the quality scores and the
+ * perceptual hash are computed.
+ */
+constexpr int previewImageSize = 640;
+
+/**
+ * Returns a vector of the pool or an empty vector if the pool is empty. The returned vector is
+ * cleared but keeps its capacity.
+ */
+template <typename T> std::vector<T> takeFromPool(std::vector<std::vector<T> >& pool)
+{
+    if (pool.empty())
+        return std::vector<T>();
+
+    std::vector<T> vector = std::move(pool.back());
+    pool.pop_back();
+    vector.clear();
+    return vector;
+}
+
+/**
+ * Checks if the corners form a plausible chessboard grid: neighboring corners have similar
+ * distances and directions and no cell of the grid is flipped or collapsed.
+ */
+bool isValidGrid(const std::vector<cv::Point2f>& corners, const cv::Size2i& gridSize)
+{
+    if (corners.size() != static_cast<size_t>(gridSize.area()))
+        return false;
+
+    const auto corner = [&corners, &gridSize](int row, int col) -> const cv::Point2f& {
+        return corners[row * gridSize.width + col];
+    };
+
+    // two successive steps along a row or column must have a similar length and direction
+    const auto isSmoothStep = [](const cv::Point2f& step1, const cv::Point2f& step2) {
+        const double length1 = cv::norm(step1);
+        const double length2 = cv::norm(step2);
+        if (length1 < 1 || length2 < 1)
+            return false;
+
+        const double ratio = length2 / length1;
+        const double cosAngle = step1.dot(step2) / (length1 * length2);
+        return ratio > 0.5 && ratio < 2.0 && cosAngle > 0.9;
+    };
+
+    for (int row = 0; row < gridSize.height; ++row)
+        for (int col = 1; col + 1 < gridSize.width; ++col)
+            if (!isSmoothStep(corner(row, col) - corner(row, col - 1),
+                    corner(row, col + 1) - corner(row, col)))
+                return false;
+
+    for (int col = 0; col < gridSize.width; ++col)
+        for (int row = 1; row + 1 < gridSize.height; ++row)
+            if (!isSmoothStep(corner(row, col) - corner(row - 1, col),
+                    corner(row + 1, col) - corner(row, col)))
+                return false;
+
+    // all cells must have the same orientation
+    double orientation = 0;
+    for (int row = 0; row + 1 < gridSize.height; ++row)
+    {
+        for (int col = 0; col + 1 < gridSize.width; ++col)
+        {
+            const cv::Point2f right = corner(row, col + 1) - corner(row, col);
+            const cv::Point2f down = corner(row + 1, col) - corner(row, col);
+            const double cross = double(right.x) * down.y - double(right.y) * down.x;
+            if (orientation == 0)
+                orientation = cross;
+            if (cross * orientation <= 0)
+                return false;
+        }
+    }
+    return true;
+}
+
+float elapsedMilliseconds(const std::chrono::steady_clock::time_point& startTime)
+{
+    const std::chrono::duration<float, std::milli> elapsed
+        = std::chrono::steady_clock::now() - startTime;
+    return elapsed.count();
+}
+
+/**
+ * Interval in which a pattern detection with a time budget checks for a stop request.
+ */
+constexpr std::chrono::milliseconds stopCheckInterval(50);
+
+/**
+ * Every ladderExplorationInterval-th image runs the whole detection ladder, so that the
+ * statistics of the cheap strategies stay current if the ladder starts at a later strategy.
+ */
+constexpr size_t ladderExplorationInterval = 16;
+
+/**
+ * Minimum number of attempts of a strategy before the ladder can start with it.
+ */
+constexpr size_t minLadderSamples = 8;
+
+using CornerDetector = DetectionWorkerPool::Detector;
+
+/**
+ * Returns the number of distortion coefficents of the distortion model of the calibration flags.
+ */
+size_t numDistortionCoefficents(const int calibrationFlags)
+{
+    if (calibrationFlags & cv::CALIB_THIN_PRISM_MODEL)
+        return 12;
+    else if (calibrationFlags & cv::CALIB_RATIONAL_MODEL)
+        return 8;
+    else
+        return 5;
+}
+
+/**
+ * Searches the chessboard corners with the OpenCV function and flags of a detection strategy.
+ */
+bool findCornersWithStrategy(const CameraCalibration::DetectionStrategy strategy,
+    const cv::Mat& img, const cv::Size2i& patternSize, std::vector<cv::Point2f>& corners)
+{
+    switch (strategy)
+    {
+    case CameraCalibration::DetectionStrategy::DownscaledFastCheck:
+        return cv::findChessboardCorners(img, patternSize, corners,
+            cv::CALIB_CB_ADAPTIVE_THRESH | cv::CALIB_CB_FAST_CHECK);
+    case CameraCalibration::DetectionStrategy::AdaptiveNormalize:
+        return cv::findChessboardCorners(img, patternSize, corners,
+            cv::CALIB_CB_ADAPTIVE_THRESH | cv::CALIB_CB_NORMALIZE_IMAGE
+                | cv::CALIB_CB_FILTER_QUADS);
+    case CameraCalibration::DetectionStrategy::SectorBased:
+        return cv::findChessboardCornersSB(img, patternSize, corners, cv::CALIB_CB_NORMALIZE_IMAGE);
+    case CameraCalibration::DetectionStrategy::SectorBasedAccuracy:
+        return cv::findChessboardCornersSB(
+            img, patternSize, corners, cv::CALIB_CB_NORMALIZE_IMAGE | cv::CALIB_CB_ACCURACY);
+    case CameraCalibration::DetectionStrategy::SaddlePoint:
+        return findChessboardCornersSaddle(img, patternSize, corners);
+    default:
+        return cv::findChessboardCorners(img, patternSize, corners,
+            cv::CALIB_CB_ADAPTIVE_THRESH | cv::CALIB_CB_FILTER_QUADS);
+    }
+}
+
+/**
+ * Runs the detector until the deadline or a stop request. The detection can not be interrupted,
+ * so it runs on a worker of the pool and is abandoned if the deadline passes or the calibration
+ * is stopped. An abandoned detection keeps its worker busy until it finishes on its own. The time
+ * spent waiting for a free worker does not count as detection time. Detections without a deadline
+ * run in the reusable slot of the pool and do not allocate memory.
+ */
+CameraCalibration::DetectionStatus findCornersUntil(const cv::Mat& img,
+    const CornerDetector& detector, std::vector<cv::Point2f>& corners, std::vector<int>& pointIds,
+    std::chrono::steady_clock::time_point deadline, DetectionWorkerPool& workers,
+    const std::atomic<bool>& stopRequested)
+{
+    using DetectionStatus = CameraCalibration::DetectionStatus;
+
+    // Without a budget the detection is only abandoned by a stop and startDetection() waits for
+    // it before the buffers are used again, so it works on the image itself.
+    if (deadline == std::chrono::steady_clock::time_point::max())
+        return workers.detect(img, detector, corners, pointIds, stopRequested)
+            ? DetectionStatus::Found
+            : DetectionStatus::NotFound;
+
+    // A detection with a time budget can be abandoned while the next image is already decoded
+    // into the same buffer, so it works on a copy.
+    const auto promise = std::make_shared<std::promise<bool> >();
+    std::future<bool> found = promise->get_future();
+    const auto foundCorners = std::make_shared<std::vector<cv::Point2f> >();
+    const auto foundIds = std::make_shared<std::vector<int> >();
+    const auto job = [image = img.clone(), detector, foundCorners, foundIds, promise]() {
+        try
+        {
+            promise->set_value(detector(image, *foundCorners, *foundIds));
+        }
+        catch (...)
+        {
+            promise->set_exception(std::current_exception());
+        }
+    };
+
+    const auto queueTime = std::chrono::steady_clock::now();
+    if (!workers.run(job, stopRequested))
+        return DetectionStatus::NotFound;
+    deadline += std::chrono::steady_clock::now() - queueTime;
+
+    while (true)
+    {
+        const auto now = std::chrono::steady_clock::now();
+        if (now >= deadline)
+            return DetectionStatus::TimedOut;
+
+        const std::chrono::steady_clock::duration waitTime
+            = std::min<std::chrono::steady_clock::duration>(deadline - now, stopCheckInterval);
+        if (found.wait_for(waitTime) == std::future_status::ready)
+            break;
+        if (stopRequested)
+            return DetectionStatus::NotFound;
+    }
+
+    if (!found.get())
+        return DetectionStatus::NotFound;
+    corners = *foundCorners;
+    pointIds = *foundIds;
+    return DetectionStatus::Found;
+}
+} // namespace
 
 CameraCalibration::CameraCalibration()
-    : chessboardCorners(7, 6)
+    : pattern(std::make_shared<ChessboardPattern>(cv::Size2i(7, 6), 0.06f))
     , cornerRefinmentWindowSize(10, 10)
-    , chessboardSquareWidth(0.06)
+    , maxCalibrationViews(0)
+    , duplicateThreshold(-1)
+    , minSharpness(0)
+    , maxClippedRatio(1)
+    , computeQualityScores(false)
+    , detectionTimeBudget(0)
+    , retryDetectionOnTimeout(true)
+    , detectionLadder({ DetectionStrategy::Default })
+    , adaptiveLadderStart(true)
+    , ladderStatistics(1)
+    , ladderDetections(0)
+    , detectionBackend(DetectionBackend::ClassicCornerSubPix)
+    , detectionWorkers(std::max(2u, std::thread::hardware_concurrency()))
+    , resumeFromJournal(true)
+    , cornerTrackingEnabled(false)
+    , roiDetectionEnabled(false)
+    , roiPadding(0.3f)
+    , interruptibleSolver(false)
     , stopRequested(false)
+    , stopRequestTime(0)
+    , stopLatency(-1)
     , reprojectionError(0)
-    , calibDataAvailabel(false)
     , calibrationFlags(0)
 {
 }
 //-------------------------------------------------------------------------------------------------
 void CameraCalibration::calibrateCamera(
-    const std::function<void(int, int, std::string)> progressFunc)
+    const std::function<void(int, int, std::string)> progressFunc,
+    const ImageResultFunc& imageResultFunc)
+{
+    // the archives of the images are only kept mapped while the calibration runs
+    try
+    {
+        runStoppable([&]() { runCalibration(progressFunc, imageResultFunc); });
+    }
+    catch (...)
+    {
+        ImageArchive::closeCachedArchives();
+        throw;
+    }
+    ImageArchive::closeCachedArchives();
+}
+//-------------------------------------------------------------------------------------------------
+void CameraCalibration::calibrateCameraFromVideo(const std::string& videoPath,
+    const VideoSampling& sampling, const std::function<void(int, int, std::string)> progressFunc,
+    const ImageResultFunc& imageResultFunc)
+{
+    runStoppable(
+        [&]() { runVideoCalibration(videoPath, sampling, progressFunc, imageResultFunc); });
+}
+//-------------------------------------------------------------------------------------------------
+void CameraCalibration::runStoppable(const std::function<void()>& calibrationFunc)
 {
     stopRequested = false;
-    calibDataAvailabel = false;
-
-    imgCorners.clear();
-    patternCorners.clear();
-    rotationVector.clear();
-    translationVector.clear();
-
-    // calculate corners from the calibration pattern
-    std::vector<cv::Point3f> chessboardCorners3d;
-    for (int i = 0; i < chessboardCorners.height; ++i)
-        for (int j = 0; j < chessboardCorners.width; ++j)
-            chessboardCorners3d.emplace_back(
-                float(j * chessboardSquareWidth), float(i * chessboardSquareWidth), 0);
+    stopLatency = -1;
 
+    try
+    {
+        calibrationFunc();
+    }
+    catch (...)
+    {
+        updateStopLatency();
+        throw;
+    }
+    updateStopLatency();
+}
+//-------------------------------------------------------------------------------------------------
+void CameraCalibration::runCalibration(
+    const std::function<void(int, int, std::string)>& progressFunc,
+    const ImageResultFunc& imageResultFunc)
+{
     if (calibImages.size() == 0)
         throw std::runtime_error("No images for calibration provided.");
 
-    const int maxNumberSteps = calibImages.size() + 1;
-    int currentStep = 0;
+    // report all broken images before the expensive pattern detection starts
+    const std::vector<ImageProblem> problems = validateImages();
+    if (!problems.empty())
+    {
+        std::string errorMsg
+            = std::to_string(problems.size()) + " image(s) can not be used for the calibration:";
+        for (size_t i = 0; i < problems.size() && i < maxReportedProblems; ++i)
+            errorMsg += "\n" + problems[i].message;
+        if (problems.size() > maxReportedProblems)
+            errorMsg += "\n...";
+        throw std::runtime_error(errorMsg);
+    }
 
-    imageSize.width = -1;
-    imageSize.height = -1;
-    for (size_t i = 0; i < calibImages.size(); ++i)
+    startDetection(calibImages.size());
+
+    // the results of an earlier run of the same images are taken from the journal
+    std::unique_ptr<DetectionJournal> journal;
+    std::vector<const DetectionJournal::Entry*> journalEntries(calibImages.size(), nullptr);
+    if (!journalPath.empty())
     {
-        calibImages[i].reprojectionError = 0;
-        calibImages[i].patternFound = false;
+        journal = std::make_unique<DetectionJournal>(
+            journalPath, detectionFingerprint(), resumeFromJournal);
+        for (const DetectionJournal::Entry& entry : journal->getEntries())
+            if (entry.imageIdx < calibImages.size()
+                && entry.info.filePath == calibImages[entry.imageIdx].filePath
+                && journal->isFileUnchanged(entry))
+                journalEntries[entry.imageIdx] = &entry;
+    }
 
-        currentStep++;
-        const cv::Mat img = cv::imread(calibImages[i].filePath, cv::IMREAD_GRAYSCALE);
+    // The ladder statistics are kept across the calibrations of this object, so they already
+    // contain the journaled images if they were detected by an earlier run of this process.
+    const bool mergeJournaledStatistics = ladderDetections == 0;
 
-        if (i == 0)
-            imageSize = img.size();
+    // the next images are read while the pattern is searched in the current one, members of
+    // archives are decoded from the mapped archive instead
+    readStatistics = BatchedFileReader::Statistics();
+    std::unique_ptr<BatchedFileReader> fileReader;
+    if (fileReaderOptions.readAhead > 0)
+    {
+        std::vector<std::string> files;
+        for (size_t i = 0; i < calibImages.size(); ++i)
+            if (!journalEntries[i] && !isArchiveMemberPath(calibImages[i].filePath))
+                files.push_back(calibImages[i].filePath);
+        fileReader = std::make_unique<BatchedFileReader>(files, fileReaderOptions);
+    }
 
-        if (img.cols != imageSize.width || img.rows != imageSize.height)
+    // the first image defines the size of all images
+    const auto checkImageSize = [this](const std::string& filePath, const cv::Size2i& size) {
+        if (imageSize.width < 0)
+            imageSize = size;
+
+        if (size != imageSize)
         {
             std::string errorMsg = "This image had the wrong size for the calibration: "
-                + calibImages[i].filePath + " expected: " + std::to_string(imageSize.width) + "x"
-                + std::to_string(imageSize.height) + " img: " + std::to_string(img.cols) + "x"
-                + std::to_string(img.rows);
+                + filePath + " expected: " + std::to_string(imageSize.width) + "x"
+                + std::to_string(imageSize.height) + " img: " + std::to_string(size.width) + "x"
+                + std::to_string(size.height);
             throw std::runtime_error(errorMsg);
         }
+    };
 
-        std::vector<cv::Point2f> cornersTemp;
-        const bool patternFound = cv::findChessboardCorners(img, chessboardCorners, cornersTemp,
-            cv::CALIB_CB_ADAPTIVE_THRESH | cv::CALIB_CB_FILTER_QUADS);
+    const int maxNumberSteps = calibImages.size() + 1;
+    int currentStep = 0;
+
+    for (size_t i = 0; i < calibImages.size(); ++i)
+    {
+        currentStep++;
+        if (journalEntries[i])
+        {
+            if (stopRequested)
+                return;
+
+            checkImageSize(calibImages[i].filePath, journalEntries[i]->imageSize);
+            restoreImage(i, journalEntries[i]->info, journalEntries[i]->ladderStatistics,
+                mergeJournaledStatistics, imageResultFunc);
+            progressFunc(currentStep, maxNumberSteps, calibImages[i].filePath);
+            continue;
+        }
+
+        const auto startTime = std::chrono::steady_clock::now();
+        const cv::Mat img = readGrayscaleImage(calibImages[i].filePath, fileReader.get());
 
         if (stopRequested)
             return;
 
-        if (!patternFound)
-        {
-            calibImages[i].patternFound = false;
-            progressFunc(currentStep, maxNumberSteps, calibImages[i].filePath);
+        checkImageSize(calibImages[i].filePath, img.size());
+
+        if (!processImage(img, i, startTime, imageResultFunc))
+            return;
+        if (journal)
+            journal->append(i, imageSize, calibImages[i], imageLadderStatistics);
+        progressFunc(currentStep, maxNumberSteps, calibImages[i].filePath);
+    }
+    if (fileReader)
+        readStatistics = fileReader->getStatistics();
+
+    if (!solve())
+        return;
+    currentStep++;
+    progressFunc(currentStep, maxNumberSteps, "");
+
+    finishCalibration(imageResultFunc);
+
+    // a finished calibration is not resumed
+    if (journal)
+        journal->remove();
+}
+//-------------------------------------------------------------------------------------------------
+void CameraCalibration::runVideoCalibration(const std::string& videoPath,
+    const VideoSampling& sampling, const std::function<void(int, int, std::string)>& progressFunc,
+    const ImageResultFunc& imageResultFunc)
+{
+    cv::VideoCapture video(videoPath);
+    if (!video.isOpened())
+        throw std::runtime_error("Could not open the video: \"" + videoPath + "\"");
+
+    const double frameRate = video.get(cv::CAP_PROP_FPS);
+    int frameStride = std::max(1, sampling.frameStride);
+    if (sampling.sampleRate > 0 && frameRate > 0)
+        frameStride = std::max(1, static_cast<int>(std::lround(frameRate / sampling.sampleRate)));
+
+    // the number of frames is only an estimate for some containers and unknown for streams
+    const int frameCount = static_cast<int>(video.get(cv::CAP_PROP_FRAME_COUNT));
+    int maxNumberSteps = frameCount > 0 ? frameCount / frameStride + 1 : 0;
+    if (sampling.maxFrames > 0)
+        maxNumberSteps = std::min<int>(maxNumberSteps > 0 ? maxNumberSteps : INT_MAX,
+            static_cast<int>(sampling.maxFrames) + 1);
+    int currentStep = 0;
+
+    // the sampled frames replace the current files
+    calibImages.clear();
+    calibImages.reserve(std::max(maxNumberSteps, 0));
+    startDetection(std::max(maxNumberSteps, 0));
+
+    cv::Mat frame;
+    cv::Mat img;
+    cv::Mat previousImg;
+    std::vector<cv::Point2f> previousCorners;
+    for (int frameIdx = 0; sampling.maxFrames == 0 || calibImages.size() < sampling.maxFrames;
+         ++frameIdx)
+    {
+        if (stopRequested)
+            return;
+
+        // grab() only reads the next frame, it is neither converted nor copied
+        const auto startTime = std::chrono::steady_clock::now();
+        if (!video.grab())
+            break;
+        if (frameIdx % frameStride != 0)
             continue;
+
+        if (!video.retrieve(frame) || frame.empty())
+            break;
+
+        // some backends deliver BGRA frames, e.g. for screen recordings
+        if (frame.channels() == 3)
+            cv::cvtColor(frame, img, cv::COLOR_BGR2GRAY);
+        else if (frame.channels() == 4)
+            cv::cvtColor(frame, img, cv::COLOR_BGRA2GRAY);
+        else
+            img = frame;
+
+        if (calibImages.empty())
+            imageSize = img.size();
+
+        CalibImgInfo imgInfo;
+        imgInfo.filePath = videoPath;
+        imgInfo.frameIndex = frameIdx;
+        calibImages.push_back(std::move(imgInfo));
+
+        // follow the corners of the previous frame, they are only set if the tracking is enabled
+        currentStep++;
+        const size_t idx = calibImages.size() - 1;
+        if (!processImage(img, idx, startTime, imageResultFunc, previousImg, previousCorners))
+            return;
+        progressFunc(currentStep, std::max(maxNumberSteps, currentStep + 1), videoPath);
+
+        // a skipped frame has no corners, the tracking continues from the last processed frame
+        if (cornerTrackingEnabled && calibImages[idx].skipReason == SkipReason::None)
+        {
+            previousCorners = calibImages[idx].boardCornersImg;
+            img.copyTo(previousImg);
+        }
+    }
+
+    if (calibImages.empty())
+        throw std::runtime_error("The video does not contain any frames: \"" + videoPath + "\"");
+
+    if (!solve())
+        return;
+    currentStep++;
+    progressFunc(currentStep, currentStep, "");
+
+    finishCalibration(imageResultFunc);
+}
+//-------------------------------------------------------------------------------------------------
+void CameraCalibration::startDetection(const size_t expectedViews)
+{
+    // a detection of the last calibration which was abandoned by a stop may still use the buffers
+    detectionWorkers.waitUntilIdle();
+
+    // the point vectors of the last calibration are reused for the new observations
+    for (auto& corners : imgCorners)
+        spareImgCorners.push_back(std::move(corners));
+    for (auto& corners : patternCorners)
+        sparePatternCorners.push_back(std::move(corners));
+    imgCorners.clear();
+    patternCorners.clear();
+    observationImageIdx.clear();
+    selectedObservations.clear();
+    rotationVector.clear();
+    translationVector.clear();
+
+    imageSize.width = -1;
+    imageSize.height = -1;
+    lastBoardRect = cv::Rect();
+    imageHashes.clear();
+
+    // all memory for the observations is allocated before the detection loop starts
+    const size_t numPoints = pattern->getObjectPoints().size();
+    imgCorners.reserve(expectedViews);
+    patternCorners.reserve(expectedViews);
+    observationImageIdx.reserve(expectedViews);
+    imageHashes.reserve(expectedViews);
+    while (spareImgCorners.size() < expectedViews)
+        spareImgCorners.emplace_back();
+    while (sparePatternCorners.size() < expectedViews)
+        sparePatternCorners.emplace_back();
+    for (auto& corners : spareImgCorners)
+        corners.reserve(numPoints);
+    for (auto& corners : sparePatternCorners)
+        corners.reserve(numPoints);
+    for (auto& imgInfo : calibImages)
+    {
+        imgInfo.boardCornersImg.reserve(numPoints);
+        imgInfo.pointIds.reserve(numPoints);
+    }
+    detectionBuffers.corners.reserve(numPoints);
+    detectionBuffers.pointIds.reserve(numPoints);
+}
+//-------------------------------------------------------------------------------------------------
+cv::Mat CameraCalibration::readGrayscaleImage(
+    const std::string& filePath, BatchedFileReader* fileReader)
+{
+    if (isArchiveMemberPath(filePath))
+        return decodeArchiveMember(filePath, cv::IMREAD_GRAYSCALE, &detectionBuffers.image);
+
+    const bool fileRead = fileReader ? fileReader->readNext(detectionBuffers.fileData)
+                                     : readFileInto(filePath, detectionBuffers.fileData);
+    if (!fileRead || detectionBuffers.fileData.empty())
+        return cv::Mat();
+
+    // cv::imdecode() reuses the buffer if the image has the size of the last one, it is released
+    // if the decoding fails
+    return cv::imdecode(detectionBuffers.fileData, cv::IMREAD_GRAYSCALE, &detectionBuffers.image);
+}
+//-------------------------------------------------------------------------------------------------
+bool CameraCalibration::processImage(const cv::Mat& img, const size_t idx,
+    const std::chrono::steady_clock::time_point& startTime, const ImageResultFunc& imageResultFunc,
+    const cv::Mat& previousImg, const std::vector<cv::Point2f>& previousCorners)
+{
+    CalibImgInfo& imgInfo = calibImages[idx];
+    imgInfo.reprojectionError = 0;
+    imgInfo.patternFound = false;
+    imgInfo.usedForCalibration = false;
+    imgInfo.cornersTracked = false;
+    imgInfo.detectedInRoi = false;
+    imgInfo.detectionTimedOut = false;
+    imgInfo.detectionStrategy = DetectionStrategy::Default;
+    imgInfo.skipReason = SkipReason::None;
+    imgInfo.boardCornersImg.clear();
+    imgInfo.pointIds.clear();
+    imgInfo.sharpness = 0;
+    imgInfo.clippedRatio = 0;
+    imageLadderStatistics.assign(detectionLadder.size(), StrategyStatistics());
+
+    const auto skipImage = [&](const SkipReason reason) {
+        imgInfo.skipReason = reason;
+        imgInfo.detectionTime = elapsedMilliseconds(startTime);
+        if (imageResultFunc)
+            imageResultFunc(idx, imgInfo);
+    };
+
+    // the image filters and the fast check work on a small copy of the image, which is only
+    // created if one of them is used
+    const bool chessboard = pattern->getType() == CalibrationPattern::Type::Chessboard;
+    const bool qualityFilter = minSharpness > 0 || maxClippedRatio < 1;
+    const bool fastCheck = chessboard
+        && std::find(detectionLadder.begin(), detectionLadder.end(),
+               DetectionStrategy::DownscaledFastCheck)
+            != detectionLadder.end();
+    cv::Mat preview;
+    if (qualityFilter || computeQualityScores || duplicateThreshold >= 0 || fastCheck)
+    {
+        createPreviewImage(img, previewImageSize, detectionBuffers.preview);
+        preview = detectionBuffers.preview;
+    }
+
+    if (qualityFilter || computeQualityScores)
+    {
+        const ImageQuality quality = computeImageQuality(preview, detectionBuffers.laplacian);
+        imgInfo.sharpness = quality.sharpness;
+        imgInfo.clippedRatio = quality.clippedRatio;
+
+        if (quality.sharpness < minSharpness)
+        {
+            skipImage(SkipReason::Blurred);
+            return true;
+        }
+        if (quality.clippedRatio > maxClippedRatio)
+        {
+            skipImage(SkipReason::BadExposure);
+            return true;
         }
+    }
 
-        if (cornerRefinmentWindowSize.width > 0 && cornerRefinmentWindowSize.height > 0)
+    // near-duplicates of processed images add no information, so their detection is skipped
+    if (duplicateThreshold >= 0)
+    {
+        imgInfo.perceptualHash = computeDifferenceHash(preview);
+        if (imageHashes.containsSimilar(imgInfo.perceptualHash, duplicateThreshold))
         {
-            try
+            skipImage(SkipReason::NearDuplicate);
+            return true;
+        }
+        imageHashes.add(imgInfo.perceptualHash);
+    }
+
+    // the corners are only tracked into images which passed the checks, tracked corners only need
+    // to be refined
+    std::vector<cv::Point2f>& cornersTemp = detectionBuffers.corners;
+    std::vector<int>& pointIds = detectionBuffers.pointIds;
+    cornersTemp.clear();
+    pointIds.clear();
+    if (chessboard && !previousCorners.empty())
+        imgInfo.cornersTracked = trackCorners(previousImg, img, previousCorners, cornersTemp);
+    bool patternFound = imgInfo.cornersTracked
+        || (chessboard ? detectCorners(img, preview, cornersTemp, imgInfo)
+                       : detectPattern(img, cornersTemp, pointIds, imgInfo));
+
+    if (stopRequested)
+        return false;
+
+    // the retry has its own time budget, so an image takes at most twice the budget
+    if (imgInfo.detectionTimedOut)
+    {
+        if (retryDetectionOnTimeout && chessboard)
+        {
+            if (preview.empty())
             {
-                // TODO make this an option for the gui
-                if (true)
-                    cv::cornerSubPix(img, cornersTemp, cornerRefinmentWindowSize, cv::Size(-1, -1),
-                        cv::TermCriteria(cv::TermCriteria::COUNT + cv::TermCriteria::EPS, 30, 0.1));
-                else
-                    cv::find4QuadCornerSubpix(img, cornersTemp, cornerRefinmentWindowSize);
+                createPreviewImage(img, previewImageSize, detectionBuffers.preview);
+                preview = detectionBuffers.preview;
             }
+            imgInfo.detectionStrategy = DetectionStrategy::DownscaledFastCheck;
+            patternFound = detectWithStrategy(imgInfo.detectionStrategy, img, preview,
+                               detectionDeadline(), cornersTemp, imgInfo)
+                == DetectionStatus::Found;
+        }
+        if (!patternFound)
+            imgInfo.skipReason = SkipReason::TimedOut;
+    }
 
-            catch (const cv::Exception& e)
-            {
-                calibImages[i].patternFound = false;
-                progressFunc(currentStep, maxNumberSteps, calibImages[i].filePath);
+    // the next image is searched around this board position first
+    lastBoardRect = patternFound ? cv::boundingRect(cornersTemp) : cv::Rect();
 
-                std::cout << "OpenCV exception for image " << i
-                          << " during subpixel refinment: " << e.what() << std::endl;
-                continue;
+    if (!patternFound)
+    {
+        imgInfo.detectionTime = elapsedMilliseconds(startTime);
+        if (imageResultFunc)
+            imageResultFunc(idx, imgInfo);
+        return true;
+    }
+
+    // a chessboard is always found completely
+    if (pointIds.empty())
+    {
+        pointIds.resize(cornersTemp.size());
+        std::iota(pointIds.begin(), pointIds.end(), 0);
+    }
+
+    // the sector based detector already locates the corners with subpixel accuracy and the
+    // centers of circles are no corners
+    const bool sectorBased = !imgInfo.cornersTracked
+        && (imgInfo.detectionStrategy == DetectionStrategy::SectorBased
+            || imgInfo.detectionStrategy == DetectionStrategy::SectorBasedAccuracy);
+    if (!sectorBased && pattern->hasCorners() && cornerRefinmentWindowSize.width > 0
+        && cornerRefinmentWindowSize.height > 0)
+    {
+        try
+        {
+            if (!refineCorners(img, cornersTemp))
+                return false;
+        }
+
+        catch (const cv::Exception& e)
+        {
+            imgInfo.detectionTime = elapsedMilliseconds(startTime);
+            if (imageResultFunc)
+                imageResultFunc(idx, imgInfo);
+
+            std::cout << "OpenCV exception for image " << idx
+                      << " during subpixel refinment: " << e.what() << std::endl;
+            return true;
+        }
+    }
+
+    imgInfo.patternFound = true;
+    imgInfo.usedForCalibration = true;
+    imgInfo.boardCornersImg = cornersTemp;
+    imgInfo.pointIds = pointIds;
+    imgInfo.detectionTime = elapsedMilliseconds(startTime);
+
+    if (stopRequested)
+        return false;
+
+    if (imageResultFunc)
+        imageResultFunc(idx, imgInfo);
+
+    imgCorners.push_back(takeFromPool(spareImgCorners));
+    imgCorners.back().assign(cornersTemp.begin(), cornersTemp.end());
+    patternCorners.push_back(takeFromPool(sparePatternCorners));
+    pattern->getObjectPoints(pointIds, patternCorners.back());
+    observationImageIdx.push_back(idx);
+    return true;
+}
+//-------------------------------------------------------------------------------------------------
+void CameraCalibration::restoreImage(const size_t idx, const CalibImgInfo& info,
+    const std::vector<StrategyStatistics>& journaledStatistics, const bool mergeStatistics,
+    const ImageResultFunc& imageResultFunc)
+{
+    CalibImgInfo& imgInfo = calibImages[idx];
+    imgInfo = info;
+
+    // the adaptive ladder start continues with the statistics of the restored images
+    if (mergeStatistics && journaledStatistics.size() == ladderStatistics.size())
+    {
+        bool usedLadder = false;
+        for (size_t rung = 0; rung < ladderStatistics.size(); ++rung)
+        {
+            ladderStatistics[rung].attempts += journaledStatistics[rung].attempts;
+            ladderStatistics[rung].successes += journaledStatistics[rung].successes;
+            ladderStatistics[rung].totalTime += journaledStatistics[rung].totalTime;
+            usedLadder = usedLadder || journaledStatistics[rung].attempts > 0;
+        }
+        if (usedLadder)
+            ++ladderDetections;
+    }
+
+    // the hash was added by processImage() if the image passed the quality and duplicate checks
+    if (duplicateThreshold >= 0
+        && (info.skipReason == SkipReason::None || info.skipReason == SkipReason::TimedOut))
+        imageHashes.add(info.perceptualHash);
+    lastBoardRect = info.patternFound ? cv::boundingRect(info.boardCornersImg) : cv::Rect();
+
+    if (imageResultFunc)
+        imageResultFunc(idx, imgInfo);
+
+    if (!info.patternFound)
+        return;
+
+    imgCorners.push_back(takeFromPool(spareImgCorners));
+    imgCorners.back().assign(info.boardCornersImg.begin(), info.boardCornersImg.end());
+    patternCorners.push_back(takeFromPool(sparePatternCorners));
+    pattern->getObjectPoints(info.pointIds, patternCorners.back());
+    observationImageIdx.push_back(idx);
+}
+//-------------------------------------------------------------------------------------------------
+uint64_t CameraCalibration::detectionFingerprint() const
+{
+    std::ostringstream settings;
+    settings << static_cast<int>(pattern->getType()) << ' ' << pattern->getSize().width << ' '
+             << pattern->getSize().height << ' ' << pattern->getSpacing() << ' ';
+    if (auto charuco = std::dynamic_pointer_cast<const CharucoPattern>(pattern))
+        settings << charuco->getMarkerWidth() << ' ' << charuco->getDictionaryId() << ' ';
+
+    settings << cornerRefinmentWindowSize.width << ' ' << cornerRefinmentWindowSize.height << ' '
+             << duplicateThreshold << ' ' << minSharpness << ' ' << maxClippedRatio << ' '
+             << detectionTimeBudget << ' ' << retryDetectionOnTimeout << ' '
+             << adaptiveLadderStart << ' ' << static_cast<int>(detectionBackend) << ' '
+             << roiDetectionEnabled << ' ' << roiPadding << ' ' << computeQualityScores;
+    for (const DetectionStrategy strategy : detectionLadder)
+        settings << ' ' << static_cast<int>(strategy);
+
+    // 64 bit FNV-1a
+    uint64_t hash = 14695981039346656037ull;
+    for (const char c : settings.str())
+    {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+//-------------------------------------------------------------------------------------------------
+bool CameraCalibration::detectCorners(const cv::Mat& img, const cv::Mat& preview,
+    std::vector<cv::Point2f>& corners, CalibImgInfo& imgInfo)
+{
+    const auto deadline = detectionDeadline();
+
+    // the sector based and the saddle point backends do not use the ladder
+    if (detectionBackend == DetectionBackend::SectorBased
+        || detectionBackend == DetectionBackend::SectorBasedAccuracy
+        || detectionBackend == DetectionBackend::SaddlePoint)
+    {
+        if (detectionBackend == DetectionBackend::SaddlePoint)
+            imgInfo.detectionStrategy = DetectionStrategy::SaddlePoint;
+        else
+            imgInfo.detectionStrategy = detectionBackend == DetectionBackend::SectorBased
+                ? DetectionStrategy::SectorBased
+                : DetectionStrategy::SectorBasedAccuracy;
+        const DetectionStatus status = detectWithStrategy(
+            imgInfo.detectionStrategy, img, preview, deadline, corners, imgInfo);
+        imgInfo.detectionTimedOut = status == DetectionStatus::TimedOut;
+        return status == DetectionStatus::Found;
+    }
+
+    const size_t startRung = selectLadderStart();
+    ++ladderDetections;
+
+    // the strategies are tried from cheap to expensive until one finds the pattern
+    for (size_t rung = startRung; rung < detectionLadder.size(); ++rung)
+    {
+        const auto startTime = std::chrono::steady_clock::now();
+        const DetectionStatus status
+            = detectWithStrategy(detectionLadder[rung], img, preview, deadline, corners, imgInfo);
+
+        const float time = elapsedMilliseconds(startTime);
+        StrategyStatistics& statistics = ladderStatistics[rung];
+        StrategyStatistics& imageStatistics = imageLadderStatistics[rung];
+        statistics.attempts++;
+        statistics.totalTime += time;
+        imageStatistics.attempts++;
+        imageStatistics.totalTime += time;
+
+        if (status == DetectionStatus::Found)
+        {
+            statistics.successes++;
+            imageStatistics.successes++;
+            imgInfo.detectionStrategy = detectionLadder[rung];
+            return true;
+        }
+
+        imgInfo.detectionTimedOut = status == DetectionStatus::TimedOut;
+        if (stopRequested || imgInfo.detectionTimedOut)
+            return false;
+    }
+    return false;
+}
+//-------------------------------------------------------------------------------------------------
+bool CameraCalibration::detectPattern(const cv::Mat& img, std::vector<cv::Point2f>& points,
+    std::vector<int>& pointIds, CalibImgInfo& imgInfo) const
+{
+    // the detection can outlive this call if it is abandoned, so it keeps its own reference
+    const std::shared_ptr<const CalibrationPattern> detectionPattern = pattern;
+    const CornerDetector detector = [detectionPattern](const cv::Mat& image,
+                                        std::vector<cv::Point2f>& foundPoints,
+                                        std::vector<int>& foundIds) {
+        return detectionPattern->detect(image, foundPoints, foundIds);
+    };
+
+    const DetectionStatus status = findCornersUntil(
+        img, detector, points, pointIds, detectionDeadline(), detectionWorkers, stopRequested);
+    imgInfo.detectionTimedOut = status == DetectionStatus::TimedOut;
+    return status == DetectionStatus::Found;
+}
+//-------------------------------------------------------------------------------------------------
+CameraCalibration::DetectionStatus CameraCalibration::detectWithStrategy(
+    const DetectionStrategy strategy, const cv::Mat& img, const cv::Mat& preview,
+    const std::chrono::steady_clock::time_point& deadline, std::vector<cv::Point2f>& corners,
+    CalibImgInfo& imgInfo) const
+{
+    const cv::Size2i patternSize = pattern->getSize();
+    const CornerDetector detector = [strategy, patternSize](const cv::Mat& image,
+                                        std::vector<cv::Point2f>& foundCorners,
+                                        std::vector<int>&) {
+        return findCornersWithStrategy(strategy, image, patternSize, foundCorners);
+    };
+
+    // the ids of the complete chessboard are assigned by processImage()
+    std::vector<int> pointIds;
+
+    // the fast check searches the whole downscaled image and maps the pixel centers back into
+    // the full image, the corners are refined afterwards
+    if (strategy == DetectionStrategy::DownscaledFastCheck)
+    {
+        const DetectionStatus status = findCornersUntil(
+            preview, detector, corners, pointIds, deadline, detectionWorkers, stopRequested);
+        if (status != DetectionStatus::Found)
+            return status;
+
+        const float scaleX = float(img.cols) / preview.cols;
+        const float scaleY = float(img.rows) / preview.rows;
+        for (auto& corner : corners)
+        {
+            corner.x = (corner.x + 0.5f) * scaleX - 0.5f;
+            corner.y = (corner.y + 0.5f) * scaleY - 0.5f;
+        }
+        return status;
+    }
+
+    // search the board first around its position in the last image
+    if (roiDetectionEnabled && !lastBoardRect.empty())
+    {
+        const int paddingX = std::max(minRoiPadding, int(lastBoardRect.width * roiPadding));
+        const int paddingY = std::max(minRoiPadding, int(lastBoardRect.height * roiPadding));
+        const cv::Rect roi = cv::Rect(lastBoardRect.x - paddingX, lastBoardRect.y - paddingY,
+                                 lastBoardRect.width + 2 * paddingX,
+                                 lastBoardRect.height + 2 * paddingY)
+            & cv::Rect(0, 0, img.cols, img.rows);
+
+        if (roi.area() < img.cols * img.rows)
+        {
+            const DetectionStatus status
+                = findCornersUntil(img(roi), detector, corners, pointIds, deadline,
+                    detectionWorkers, stopRequested);
+            if (status == DetectionStatus::Found)
+            {
+                for (auto& corner : corners)
+                {
+                    corner.x += roi.x;
+                    corner.y += roi.y;
+                }
+                imgInfo.detectedInRoi = true;
+                return status;
             }
+
+            if (stopRequested || status == DetectionStatus::TimedOut)
+                return status;
         }
+    }
 
-        calibImages[i].patternFound = true;
-        calibImages[i].boardCornersImg = cornersTemp;
+    return findCornersUntil(
+        img, detector, corners, pointIds, deadline, detectionWorkers, stopRequested);
+}
+//-------------------------------------------------------------------------------------------------
+size_t CameraCalibration::selectLadderStart() const
+{
+    if (!adaptiveLadderStart || detectionLadder.size() < 2
+        || ladderDetections % ladderExplorationInterval == 0)
+        return 0;
 
-        if (stopRequested)
-            return;
+    // The expected cost of a start rung is the sum of the mean times of the following rungs,
+    // weighted with the probability that all rungs before them failed. The attempts are
+    // assumed to be independent.
+    size_t bestStart = 0;
+    double bestCost = std::numeric_limits<double>::max();
+    for (size_t start = 0; start < detectionLadder.size(); ++start)
+    {
+        if (ladderStatistics[start].attempts < minLadderSamples)
+            continue;
 
-        imgCorners.push_back(std::move(cornersTemp));
-        patternCorners.push_back(chessboardCorners3d);
-        progressFunc(currentStep, maxNumberSteps, calibImages[i].filePath);
+        double cost = 0;
+        double reachProbability = 1;
+        for (size_t rung = start; rung < detectionLadder.size(); ++rung)
+        {
+            const StrategyStatistics& statistics = ladderStatistics[rung];
+            if (statistics.attempts == 0)
+                break;
+
+            cost += reachProbability * statistics.totalTime / statistics.attempts;
+            reachProbability *= 1 - double(statistics.successes) / statistics.attempts;
+        }
+
+        if (cost < bestCost)
+        {
+            bestCost = cost;
+            bestStart = start;
+        }
+    }
+    return bestStart;
+}
+//-------------------------------------------------------------------------------------------------
+std::chrono::steady_clock::time_point CameraCalibration::detectionDeadline() const
+{
+    if (detectionTimeBudget <= 0)
+        return std::chrono::steady_clock::time_point::max();
+
+    return std::chrono::steady_clock::now()
+        + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<float, std::milli>(detectionTimeBudget));
+}
+//-------------------------------------------------------------------------------------------------
+bool CameraCalibration::trackCorners(const cv::Mat& previousImg, const cv::Mat& img,
+    const std::vector<cv::Point2f>& previousCorners, std::vector<cv::Point2f>& corners)
+{
+    const cv::Size windowSize(21, 21);
+    constexpr int maxPyramidLevel = 3;
+    const cv::TermCriteria criteria(cv::TermCriteria::COUNT + cv::TermCriteria::EPS, 30, 0.01);
+
+    std::vector<uchar>& status = detectionBuffers.trackingStatus;
+    std::vector<float>& errors = detectionBuffers.trackingErrors;
+    cv::calcOpticalFlowPyrLK(previousImg, img, previousCorners, corners, status, errors,
+        windowSize, maxPyramidLevel, criteria);
+    if (std::find(status.begin(), status.end(), 0) != status.end())
+    {
+        corners.clear();
+        return false;
     }
 
+    // track the corners back to the previous frame, corners which do not end at their start
+    // position were not tracked reliably
+    std::vector<cv::Point2f>& backTrackedCorners = detectionBuffers.backTrackedCorners;
+    cv::calcOpticalFlowPyrLK(img, previousImg, corners, backTrackedCorners, status, errors,
+        windowSize, maxPyramidLevel, criteria);
+    for (size_t i = 0; i < corners.size(); ++i)
+    {
+        if (!status[i] || cv::norm(backTrackedCorners[i] - previousCorners[i]) > maxTrackingError)
+        {
+            corners.clear();
+            return false;
+        }
+    }
+
+    if (!isValidGrid(corners, pattern->getSize()))
+    {
+        corners.clear();
+        return false;
+    }
+    return true;
+}
+//-------------------------------------------------------------------------------------------------
+bool CameraCalibration::solve()
+{
+    // views which add little information are not used to speed up the solver
+    if (maxCalibrationViews > 0)
+        selectedObservations
+            = selectViews(imgCorners, patternCorners, imageSize, maxCalibrationViews);
+    else
+    {
+        selectedObservations.resize(imgCorners.size());
+        std::iota(selectedObservations.begin(), selectedObservations.end(), 0);
+    }
+
+    std::vector<std::vector<cv::Point2f> > selectedImgCorners;
+    std::vector<std::vector<cv::Point3f> > selectedPatternCorners;
+    const bool useSubset = selectedObservations.size() < imgCorners.size();
+    if (useSubset)
+    {
+        for (size_t idx = 0; idx < observationImageIdx.size(); ++idx)
+            calibImages[observationImageIdx[idx]].usedForCalibration = false;
+
+        for (const size_t idx : selectedObservations)
+        {
+            calibImages[observationImageIdx[idx]].usedForCalibration = true;
+            selectedImgCorners.push_back(imgCorners[idx]);
+            selectedPatternCorners.push_back(patternCorners[idx]);
+        }
+    }
+    const auto& solverImgCorners = useSubset ? selectedImgCorners : imgCorners;
+    const auto& solverPatternCorners = useSubset ? selectedPatternCorners : patternCorners;
+
     try
     {
         calibrationMatrix = cv::Mat::eye(3, 3, CV_64F);
         distortionCoefficients = cv::Mat::zeros(12, 1, CV_64F);
 
+        // A run of the solver can not be interrupted. The interruptible solver restarts it
+        // after every step with the intrinsics of the step before and checks for a stop request
+        // in between.
         // TODO make the number of iterations changeable
-        cv::calibrateCamera(patternCorners, imgCorners, imageSize, calibrationMatrix,
-            distortionCoefficients, rotationVector, translationVector, calibrationFlags,
-            cv::TermCriteria(cv::TermCriteria::COUNT + cv::TermCriteria::EPS, 30, DBL_EPSILON));
-        currentStep++;
-        progressFunc(currentStep, maxNumberSteps, "");
+        const int stepIterations
+            = interruptibleSolver ? solverIterationsPerStep : maxSolverIterations;
+        int flags = calibrationFlags;
+        for (int iterations = 0; iterations < maxSolverIterations; iterations += stepIterations)
+        {
+            cv::calibrateCamera(solverPatternCorners, solverImgCorners, imageSize,
+                calibrationMatrix, distortionCoefficients, rotationVector, translationVector, flags,
+                cv::TermCriteria(cv::TermCriteria::COUNT + cv::TermCriteria::EPS,
+                    std::min(stepIterations, maxSolverIterations - iterations), DBL_EPSILON));
+            flags |= cv::CALIB_USE_INTRINSIC_GUESS;
+
+            if (stopRequested)
+                return false;
+        }
     }
     catch (const cv::Exception& ex)
     {
         std::cout << "ex.what() = " << ex.what() << std::endl;
     }
-
+    return true;
+}
+//-------------------------------------------------------------------------------------------------
+void CameraCalibration::finishCalibration(const ImageResultFunc& imageResultFunc)
+{
     reprojectionError = computeReprojectionError();
     // computeDistortUndistortError(); // TODO Display this error inside of the
     // gui
-    calibDataAvailabel = true;
+    publishResult();
+
+    // publish the reprojection errors of the images which were used for the calibration
+    if (imageResultFunc)
+        for (size_t i = 0; i < calibImages.size(); ++i)
+            if (calibImages[i].patternFound)
+                imageResultFunc(i, calibImages[i]);
+}
+//-------------------------------------------------------------------------------------------------
+std::vector<CameraCalibration::ImageProblem> CameraCalibration::validateImages() const
+{
+    std::vector<ImageHeader> headers(calibImages.size());
+    std::vector<std::string> errors(calibImages.size());
+
+    cv::parallel_for_(cv::Range(0, static_cast<int>(calibImages.size())),
+        [this, &headers, &errors](const cv::Range& range) {
+            for (int i = range.start; i < range.end; ++i)
+            {
+                try
+                {
+                    headers[i] = readImageHeader(calibImages[i].filePath);
+                }
+                catch (const std::runtime_error& e)
+                {
+                    errors[i] = e.what();
+                }
+            }
+        });
+
+    std::vector<ImageProblem> problems;
+    cv::Size2i expectedSize(-1, -1);
+    for (size_t i = 0; i < calibImages.size(); ++i)
+    {
+        ImageProblem problem;
+        problem.index = i;
+        problem.filePath = calibImages[i].filePath;
+
+        if (!errors[i].empty())
+        {
+            problem.message = errors[i];
+            problems.push_back(std::move(problem));
+            continue;
+        }
+
+        // the size of other formats is checked when the image is decoded
+        if (headers[i].format == ImageHeader::Format::Unknown)
+        {
+            if (!cv::haveImageReader(calibImages[i].filePath))
+            {
+                problem.message = "Unsupported image format: " + calibImages[i].filePath;
+                problems.push_back(std::move(problem));
+            }
+            continue;
+        }
+
+        if (expectedSize.width < 0)
+            expectedSize = headers[i].size;
+
+        if (headers[i].size != expectedSize)
+        {
+            problem.message = "This image had the wrong size for the calibration: "
+                + calibImages[i].filePath + " expected: " + std::to_string(expectedSize.width)
+                + "x" + std::to_string(expectedSize.height)
+                + " img: " + std::to_string(headers[i].size.width) + "x"
+                + std::to_string(headers[i].size.height);
+            problems.push_back(std::move(problem));
+        }
+    }
+    return problems;
+}
+//-------------------------------------------------------------------------------------------------
+bool CameraCalibration::refineCorners(const cv::Mat& img, std::vector<cv::Point2f>& corners) const
+{
+    // The corners are refined in chunks to be able to react on a stop request. The refinement of
+    // a corner does not depend on the other corners, therefore the result is the same as refining
+    // all corners at once. The chunks are headers on the corner vector and refined in place, so
+    // different chunks can be refined by different threads.
+    const int numChunks
+        = static_cast<int>((corners.size() + refinementChunkSize - 1) / refinementChunkSize);
+    const auto refineChunks = [&](const cv::Range& range) {
+        for (int chunkIdx = range.start; chunkIdx < range.end; ++chunkIdx)
+        {
+            if (stopRequested)
+                return;
+
+            const size_t start = chunkIdx * refinementChunkSize;
+            const int count
+                = static_cast<int>(std::min(refinementChunkSize, corners.size() - start));
+            cv::Mat chunk(count, 1, CV_32FC2, &corners[start]);
+
+            if (detectionBackend != DetectionBackend::ClassicFind4Quad)
+                cv::cornerSubPix(img, chunk, cornerRefinmentWindowSize, cv::Size(-1, -1),
+                    cv::TermCriteria(cv::TermCriteria::COUNT + cv::TermCriteria::EPS, 30, 0.1));
+            else
+                cv::find4QuadCornerSubpix(img, chunk, cornerRefinmentWindowSize);
+        }
+    };
+
+    if (corners.size() >= parallelRefinementMinCorners)
+        cv::parallel_for_(cv::Range(0, numChunks), refineChunks);
+    else
+        refineChunks(cv::Range(0, numChunks));
+    return !stopRequested;
+}
+//-------------------------------------------------------------------------------------------------
+void CameraCalibration::updateStopLatency()
+{
+    if (!stopRequested)
+        return;
+
+    const auto requestTime = std::chrono::steady_clock::time_point(
+        std::chrono::steady_clock::duration(stopRequestTime.load()));
+    stopLatency = elapsedMilliseconds(requestTime);
+}
+//-------------------------------------------------------------------------------------------------
+void CameraCalibration::publishResult(const bool withImages)
+{
+    auto newResult = std::make_shared<CalibrationResult>();
+
+    // the matrices are cloned because the members are reused by the next calibration
+    newResult->cameraMatrix = calibrationMatrix.clone();
+    newResult->distCoeffs = distortionCoefficients.clone();
+    newResult->numDistortionCoefficents
+        = std::min<size_t>(numDistortionCoefficents(static_cast<int>(calibrationFlags)),
+            distortionCoefficients.total());
+    newResult->calibrationFlags = static_cast<int>(calibrationFlags);
+    newResult->imageSize = imageSize;
+    newResult->chessboardSize = pattern->getSize();
+    newResult->pattern = pattern;
+    newResult->reprojectionError = reprojectionError;
+    if (withImages)
+    {
+        newResult->images = calibImages;
+        newResult->numUsedImages = std::count_if(calibImages.begin(), calibImages.end(),
+            [](const CalibImgInfo& info) { return info.usedForCalibration; });
+    }
+
+    std::atomic_store(&result, CalibrationResultPtr(std::move(newResult)));
 }
 //-------------------------------------------------------------------------------------------------
 void CameraCalibration::saveCameraParameters(const std::string& filePath) const
@@ -149,47 +1287,77 @@ void CameraCalibration::saveCameraParameters(const std::string& filePath) const
     const auto extension = fs::path(filePath).extension().string();
     if (extension == ".xml")
         exportCameraParametersCv(filePath);
+    else if (filePath.size() > 11 && filePath.compare(filePath.size() - 11, 11, ".views.json") == 0)
+        exportCameraParametersJSONWithViews(filePath);
     else if (extension == ".json")
         exportCameraParametersJSON(filePath);
+    else if (extension == ".bcal")
+        exportCameraParametersBinary(filePath);
+}
+//-------------------------------------------------------------------------------------------------
+void CameraCalibration::exportCameraParametersBinary(const std::string& filePath) const
+{
+    const CalibrationResultPtr currentResult = getResult();
+    if (!currentResult)
+        throw std::runtime_error("There are no camera parameters to save.");
+    writeBcalFile(filePath, *currentResult);
 }
 //-------------------------------------------------------------------------------------------------
 void CameraCalibration::exportCameraParametersCv(const std::string& filePath) const
 {
+    const CalibrationResultPtr currentResult = getResult();
+    if (!currentResult)
+        throw std::runtime_error("There are no camera parameters to save.");
+
     cv::FileStorage fs(filePath, cv::FileStorage::WRITE); // Read the settings
     if (!fs.isOpened())
         throw std::runtime_error("Could not open the configuration file: \"" + filePath + "\"");
 
-    fs << "fx" << calibrationMatrix.at<double>(0, 0);
-    fs << "fy" << calibrationMatrix.at<double>(1, 1);
-    fs << "cx" << calibrationMatrix.at<double>(0, 2);
-    fs << "cy" << calibrationMatrix.at<double>(1, 2);
-    fs << "distortion_coefficients" << distortionCoefficients;
-    fs << "vertical_resolution" << imageSize.height;
-    fs << "horizontal_resolution" << imageSize.width;
-    fs << "reprojection_error" << reprojectionError;
+    const cv::Mat& cameraMatrix = currentResult->cameraMatrix;
+    fs << "fx" << cameraMatrix.at<double>(0, 0);
+    fs << "fy" << cameraMatrix.at<double>(1, 1);
+    fs << "cx" << cameraMatrix.at<double>(0, 2);
+    fs << "cy" << cameraMatrix.at<double>(1, 2);
+    fs << "distortion_coefficients" << currentResult->distCoeffs;
+    fs << "vertical_resolution" << currentResult->imageSize.height;
+    fs << "horizontal_resolution" << currentResult->imageSize.width;
+    fs << "reprojection_error" << currentResult->reprojectionError;
     fs.release();
 }
 //-------------------------------------------------------------------------------------------------
 void CameraCalibration::exportCameraParametersJSON(const std::string& filePath) const
 {
+    const CalibrationResultPtr currentResult = getResult();
+    if (!currentResult)
+        throw std::runtime_error("There are no camera parameters to save.");
+
+    const cv::Mat& cameraMatrix = currentResult->cameraMatrix;
     nlohmann::json camJson;
-    camJson["fx"] = calibrationMatrix.at<double>(0, 0);
-    camJson["fy"] = calibrationMatrix.at<double>(1, 1);
-    camJson["cx"] = calibrationMatrix.at<double>(0, 2);
-    camJson["cy"] = calibrationMatrix.at<double>(1, 2);
-    camJson["horizontal_resolution"] = imageSize.width;
-    camJson["vertical_resolution"] = imageSize.height;
+    camJson["fx"] = cameraMatrix.at<double>(0, 0);
+    camJson["fy"] = cameraMatrix.at<double>(1, 1);
+    camJson["cx"] = cameraMatrix.at<double>(0, 2);
+    camJson["cy"] = cameraMatrix.at<double>(1, 2);
+    camJson["horizontal_resolution"] = currentResult->imageSize.width;
+    camJson["vertical_resolution"] = currentResult->imageSize.height;
 
     camJson["distortion_coefficients"] = nlohmann::json::array();
-    for (size_t i = 0; i < getNumDistortionCoefficents(); ++i)
-        camJson["distortion_coefficients"].push_back(distortionCoefficients.at<double>(i, 0));
+    for (size_t i = 0; i < currentResult->numDistortionCoefficents; ++i)
+        camJson["distortion_coefficients"].push_back(currentResult->distCoeffs.at<double>(i, 0));
 
-    camJson["reprojection_error"] = reprojectionError;
+    camJson["reprojection_error"] = currentResult->reprojectionError;
 
     std::ofstream outStream(filePath);
     outStream << std::setw(4) << camJson << std::endl;
 }
 //-------------------------------------------------------------------------------------------------
+void CameraCalibration::exportCameraParametersJSONWithViews(const std::string& filePath) const
+{
+    const CalibrationResultPtr currentResult = getResult();
+    if (!currentResult)
+        throw std::runtime_error("There are no camera parameters to save.");
+    writeCalibrationJsonFile(filePath, *currentResult);
+}
+//-------------------------------------------------------------------------------------------------
 void CameraCalibration::loadCameraParametersJSON(const std::string& filePath)
 {
     std::ifstream inFileStram(filePath);
@@ -211,7 +1379,10 @@ void CameraCalibration::loadCameraParametersJSON(const std::string& filePath)
         distortionCoefficients.at<double>(i, 0) = camJson["distortion_coefficients"][i];
 
     reprojectionError = camJson.at("reprojection_error").get<double>();
-    calibDataAvailabel = true;
+
+    // loaded camera parameters do not contain any information about calibration images, the
+    // image list of the tool is kept for the next calibration
+    publishResult(false);
 }
 //-------------------------------------------------------------------------------------------------
 void CameraCalibration::loadCameraParametersXML(const std::string& filePath)
@@ -230,29 +1401,75 @@ void CameraCalibration::loadCameraParametersXML(const std::string& filePath)
     fs["vertical_resolution"] >> imageSize.height;
     fs["horizontal_resolution"] >> imageSize.width;
     fs["reprojection_error"] >> reprojectionError;
+    fs.release();
 
-    calibDataAvailabel = true;
+    // loaded camera parameters do not contain any information about calibration images, the
+    // image list of the tool is kept for the next calibration
+    publishResult(false);
+}
+//-------------------------------------------------------------------------------------------------
+void CameraCalibration::loadCameraParametersBinary(const std::string& filePath)
+{
+    const BcalFileView file(filePath);
+    CalibrationResult loaded = file.toResult();
 
-    fs.release();
+    calibrationMatrix = loaded.cameraMatrix;
+    distortionCoefficients = loaded.distCoeffs;
+    calibrationFlags = static_cast<size_t>(loaded.calibrationFlags);
+    imageSize = loaded.imageSize;
+    reprojectionError = loaded.reprojectionError;
+    pattern = loaded.pattern;
+    calibImages = std::move(loaded.images);
+    publishResult();
+}
+//-------------------------------------------------------------------------------------------------
+void CameraCalibration::loadCameraParameters(const std::string& filePath)
+{
+    namespace fs = std::filesystem;
+    const auto extension = fs::path(filePath).extension().string();
+    if (extension == ".xml")
+        loadCameraParametersXML(filePath);
+    else if (extension == ".json")
+        loadCameraParametersJSON(filePath);
+    else if (extension == ".bcal")
+        loadCameraParametersBinary(filePath);
+    else
+        throw std::runtime_error("Unknown format of the camera parameters: " + filePath);
 }
 //-------------------------------------------------------------------------------------------------
 double CameraCalibration::computeReprojectionError()
 {
-    assert(patternCorners.size() == rotationVector.size());
-    assert(patternCorners.size() == translationVector.size());
     assert(patternCorners.size() == imgCorners.size());
+    assert(patternCorners.size() == observationImageIdx.size());
+    assert(selectedObservations.size() == rotationVector.size());
+    assert(selectedObservations.size() == translationVector.size());
 
-    size_t idx = 0;
+    size_t selectedIdx = 0;
     int totalPoints = 0;
     double totalErr = 0;
-    for (size_t i = 0; i < calibImages.size(); i++)
+    for (size_t idx = 0; idx < imgCorners.size(); idx++)
     {
-        if (!calibImages[i].patternFound)
+        CalibImgInfo& imgInfo = calibImages[observationImageIdx[idx]];
+
+        // the pose of views which were not used for the calibration is estimated with the
+        // calculated intrinsics
+        cv::Mat rotation;
+        cv::Mat translation;
+        const bool used = selectedIdx < selectedObservations.size()
+            && selectedObservations[selectedIdx] == idx;
+        if (used)
+        {
+            rotation = rotationVector[selectedIdx];
+            translation = translationVector[selectedIdx];
+            selectedIdx++;
+        }
+        else if (!cv::solvePnP(patternCorners[idx], imgCorners[idx], calibrationMatrix,
+                     distortionCoefficients, rotation, translation))
             continue;
 
         std::vector<cv::Point2f> projectedPoints;
-        cv::projectPoints(cv::Mat(patternCorners[idx]), rotationVector[idx], translationVector[idx],
-            calibrationMatrix, distortionCoefficients, projectedPoints);
+        cv::projectPoints(cv::Mat(patternCorners[idx]), rotation, translation, calibrationMatrix,
+            distortionCoefficients, projectedPoints);
 
         double error = 0;
         for (size_t j = 0; j < projectedPoints.size(); ++j)
@@ -263,12 +1480,18 @@ double CameraCalibration::computeReprojectionError()
             error += sqrt(x * x + y * y);
         }
 
-        totalErr += error;
+        imgInfo.reprojectionError = error / patternCorners[idx].size();
+        imgInfo.rotation = cv::Vec3d(
+            rotation.at<double>(0), rotation.at<double>(1), rotation.at<double>(2));
+        imgInfo.translation = cv::Vec3d(
+            translation.at<double>(0), translation.at<double>(1), translation.at<double>(2));
 
-        calibImages[i].reprojectionError = error / patternCorners[idx].size();
-        totalPoints += (int)patternCorners[idx].size();
-
-        idx++;
+        // the error of the calibration only contains the views which were used for it
+        if (used)
+        {
+            totalErr += error;
+            totalPoints += (int)patternCorners[idx].size();
+        }
     }
 
     if (totalPoints == 0)
@@ -306,24 +1529,27 @@ double CameraCalibration::computeDistortUndistortError()
     return error;
 }
 //-------------------------------------------------------------------------------------------------
-const cv::Mat& CameraCalibration::getCameraMatrix() const
+CameraCalibration::CalibrationResultPtr CameraCalibration::getResult() const
+{
+    return std::atomic_load(&result);
+}
+//-------------------------------------------------------------------------------------------------
+cv::Mat CameraCalibration::getCameraMatrix() const
 {
-    return calibrationMatrix;
+    const CalibrationResultPtr currentResult = getResult();
+    return currentResult ? currentResult->cameraMatrix : cv::Mat();
 }
 //-------------------------------------------------------------------------------------------------
-const cv::Mat& CameraCalibration::getDistCoeffs() const
+cv::Mat CameraCalibration::getDistCoeffs() const
 {
-    return distortionCoefficients;
+    const CalibrationResultPtr currentResult = getResult();
+    return currentResult ? currentResult->distCoeffs : cv::Mat();
 }
 //-------------------------------------------------------------------------------------------------
 size_t CameraCalibration::getNumDistortionCoefficents() const
 {
-    if (calibrationFlags & cv::CALIB_THIN_PRISM_MODEL)
-        return 12;
-    else if (calibrationFlags & cv::CALIB_RATIONAL_MODEL)
-        return 8;
-    else
-        return 5;
+    const CalibrationResultPtr currentResult = getResult();
+    return currentResult ? currentResult->numDistortionCoefficents : 0;
 }
 //-------------------------------------------------------------------------------------------------
 std::vector<std::string> CameraCalibration::getFiles() const
@@ -355,9 +1581,15 @@ void CameraCalibration::addFile(const std::string& file)
 //-------------------------------------------------------------------------------------------------
 void CameraCalibration::stopCalibration()
 {
+    stopRequestTime = std::chrono::steady_clock::now().time_since_epoch().count();
     stopRequested = true;
 }
 //-------------------------------------------------------------------------------------------------
+void CameraCalibration::setInterruptibleSolver(const bool enabled)
+{
+    interruptibleSolver = enabled;
+}
+//-------------------------------------------------------------------------------------------------
 void CameraCalibration::removeFile(const int index)
 {
     calibImages.erase(calibImages.begin() + index);
@@ -368,9 +1600,23 @@ void CameraCalibration::clearFiles()
     calibImages.clear();
 }
 //-------------------------------------------------------------------------------------------------
+void CameraCalibration::setPattern(
+    const std::shared_ptr<const CalibrationPattern>& calibrationPattern)
+{
+    if (!calibrationPattern)
+        throw std::runtime_error("The calibration pattern must not be empty.");
+
+    pattern = calibrationPattern;
+}
+//-------------------------------------------------------------------------------------------------
+std::shared_ptr<const CalibrationPattern> CameraCalibration::getPattern() const
+{
+    return pattern;
+}
+//-------------------------------------------------------------------------------------------------
 void CameraCalibration::setChessboardSize(const cv::Size2i& chessboardSize)
 {
-    this->chessboardCorners = chessboardSize;
+    pattern = pattern->withGeometry(chessboardSize, pattern->getSpacing());
 }
 //-------------------------------------------------------------------------------------------------
 void CameraCalibration::setCornerRefinmentWindowSize(const cv::Size2i& cornerRefinmentWindowSize)
@@ -380,7 +1626,83 @@ void CameraCalibration::setCornerRefinmentWindowSize(const cv::Size2i& cornerRef
 //-------------------------------------------------------------------------------------------------
 void CameraCalibration::setChessboardSquareWidth(const float chessboardSquareWidth)
 {
-    this->chessboardSquareWidth = chessboardSquareWidth;
+    pattern = pattern->withGeometry(pattern->getSize(), chessboardSquareWidth);
+}
+//-------------------------------------------------------------------------------------------------
+void CameraCalibration::setCornerTracking(const bool enabled)
+{
+    cornerTrackingEnabled = enabled;
+}
+//-------------------------------------------------------------------------------------------------
+void CameraCalibration::setMaxCalibrationViews(const size_t maxViews)
+{
+    maxCalibrationViews = maxViews;
+}
+//-------------------------------------------------------------------------------------------------
+void CameraCalibration::setDuplicateThreshold(const int maxHammingDistance)
+{
+    duplicateThreshold = maxHammingDistance;
+}
+//-------------------------------------------------------------------------------------------------
+void CameraCalibration::setQualityThresholds(const float minSharpness, const float maxClippedRatio)
+{
+    this->minSharpness = minSharpness;
+    this->maxClippedRatio = maxClippedRatio;
+}
+//-------------------------------------------------------------------------------------------------
+void CameraCalibration::setComputeQualityScores(const bool enabled)
+{
+    computeQualityScores = enabled;
+}
+//-------------------------------------------------------------------------------------------------
+void CameraCalibration::setDetectionTimeBudget(const float milliseconds, const bool retryDownscaled)
+{
+    detectionTimeBudget = milliseconds;
+    retryDetectionOnTimeout = retryDownscaled;
+}
+//-------------------------------------------------------------------------------------------------
+void CameraCalibration::setDetectionLadder(
+    const std::vector<DetectionStrategy>& strategies, const bool adaptiveStart)
+{
+    if (strategies.empty())
+        throw std::runtime_error("The detection ladder must contain at least one strategy.");
+
+    // the statistics are kept across calibrations as long as the ladder does not change
+    if (strategies != detectionLadder)
+    {
+        detectionLadder = strategies;
+        ladderStatistics.assign(detectionLadder.size(), StrategyStatistics());
+        ladderDetections = 0;
+    }
+    adaptiveLadderStart = adaptiveStart;
+}
+//-------------------------------------------------------------------------------------------------
+void CameraCalibration::setDetectionBackend(const DetectionBackend backend)
+{
+    detectionBackend = backend;
+}
+//-------------------------------------------------------------------------------------------------
+void CameraCalibration::setRoiDetection(const bool enabled, const float padding)
+{
+    roiDetectionEnabled = enabled;
+    roiPadding = padding;
+}
+//-------------------------------------------------------------------------------------------------
+void CameraCalibration::setReadAhead(const size_t files, const bool useIoUring)
+{
+    fileReaderOptions.readAhead = files;
+    fileReaderOptions.useIoUring = useIoUring;
+}
+//-------------------------------------------------------------------------------------------------
+BatchedFileReader::Statistics CameraCalibration::getReadStatistics() const
+{
+    return readStatistics;
+}
+//-------------------------------------------------------------------------------------------------
+void CameraCalibration::setJournal(const std::string& filePath, const bool resume)
+{
+    journalPath = filePath;
+    resumeFromJournal = resume;
 }
 //-------------------------------------------------------------------------------------------------
 bool CameraCalibration::isStopRequested() const
@@ -388,29 +1710,36 @@ bool CameraCalibration::isStopRequested() const
     return stopRequested;
 }
 //-------------------------------------------------------------------------------------------------
+float CameraCalibration::getStopLatency() const
+{
+    return stopLatency;
+}
+//-------------------------------------------------------------------------------------------------
 float CameraCalibration::getReprojectionError() const
 {
-    return reprojectionError;
+    const CalibrationResultPtr currentResult = getResult();
+    return currentResult ? currentResult->reprojectionError : 0;
 }
 //-------------------------------------------------------------------------------------------------
-const std::vector<CameraCalibration::CalibImgInfo>& CameraCalibration::getCalibInfo() const
+std::vector<CameraCalibration::CalibImgInfo> CameraCalibration::getCalibInfo() const
 {
-    return calibImages;
+    const CalibrationResultPtr currentResult = getResult();
+    return currentResult ? currentResult->images : std::vector<CalibImgInfo>();
 }
 //-------------------------------------------------------------------------------------------------
 bool CameraCalibration::isCalibrationDataAvailable() const
 {
-    return this->calibDataAvailabel;
+    return getResult() != nullptr;
 }
 //-------------------------------------------------------------------------------------------------
 cv::Size2i CameraCalibration::getChessboardSize() const
 {
-    return chessboardCorners;
+    return pattern->getSize();
 }
 //-------------------------------------------------------------------------------------------------
 float CameraCalibration::getChessboardSquareWidth() const
 {
-    return chessboardSquareWidth;
+    return pattern->getSpacing();
 }
 //-------------------------------------------------------------------------------------------------
 void CameraCalibration::setCalibrationFlags(const int calibrationFlags)
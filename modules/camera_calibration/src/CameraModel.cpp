@@ -0,0 +1,218 @@
+/*
+ * CameraModel.cpp
+ *
+ *  Created on: 18.10.2026
+ */
+
+#include "camera_calibration/CameraModel.h"
+#include "camera_calibration/BcalFile.h"
+#include "camera_calibration/CalibrationJsonFile.h"
+#include "camera_calibration/utils.h"
+#include "nlohmann/json.hpp"
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <limits>
+#include <opencv2/opencv.hpp>
+#include <stdexcept>
+
+namespace libba
+{
+namespace
+{
+void setDistortion(CameraModel& model, const std::vector<double>& coefficients)
+{
+    if (coefficients.size() > cameraModelMaxDistortionCoefficients)
+        throw std::runtime_error("Too many distortion coefficients.");
+
+    std::copy(coefficients.begin(), coefficients.end(), model.distortion.begin());
+    model.numDistortionCoefficients = static_cast<uint32_t>(coefficients.size());
+}
+//-------------------------------------------------------------------------------------------------
+/**
+ * The conversion of a double which does not fit into the target type is undefined, so the
+ * numbers of the files are checked first.
+ */
+int32_t toInt32(const double value, const std::string& name)
+{
+    if (!(value >= std::numeric_limits<int32_t>::min()
+            && value <= std::numeric_limits<int32_t>::max()))
+        throw std::runtime_error("The number \"" + name + "\" is out of range.");
+    return static_cast<int32_t>(value);
+}
+//-------------------------------------------------------------------------------------------------
+float toFloat(const double value, const std::string& name)
+{
+    if (std::isfinite(value) && std::abs(value) > std::numeric_limits<float>::max())
+        throw std::runtime_error("The number \"" + name + "\" is out of range.");
+    return static_cast<float>(value);
+}
+//-------------------------------------------------------------------------------------------------
+double readXmlNumber(const cv::FileStorage& fs, const std::string& name)
+{
+    const cv::FileNode node = fs[name];
+    if (!node.isReal() && !node.isInt())
+        throw std::runtime_error("The number \"" + name + "\" is missing.");
+    return static_cast<double>(node);
+}
+//-------------------------------------------------------------------------------------------------
+CameraModel readXmlModel(const std::vector<uchar>& data)
+{
+    // the file was already read, cv::FileStorage parses it from memory
+    const std::string content(data.begin(), data.end());
+    const cv::FileStorage fs(content, cv::FileStorage::READ | cv::FileStorage::MEMORY);
+    if (!fs.isOpened())
+        throw std::runtime_error("The file is not a cv::FileStorage file.");
+
+    CameraModel model;
+    model.fx = readXmlNumber(fs, "fx");
+    model.fy = readXmlNumber(fs, "fy");
+    model.cx = readXmlNumber(fs, "cx");
+    model.cy = readXmlNumber(fs, "cy");
+    model.width = toInt32(readXmlNumber(fs, "horizontal_resolution"), "horizontal_resolution");
+    model.height = toInt32(readXmlNumber(fs, "vertical_resolution"), "vertical_resolution");
+    model.reprojectionError
+        = toFloat(readXmlNumber(fs, "reprojection_error"), "reprojection_error");
+
+    cv::Mat distortion;
+    fs["distortion_coefficients"] >> distortion;
+    if (distortion.empty())
+        throw std::runtime_error("The distortion coefficients are missing.");
+    distortion.convertTo(distortion, CV_64F);
+    const std::vector<double> coefficients(distortion.begin<double>(), distortion.end<double>());
+    setDistortion(model, coefficients);
+    return model;
+}
+//-------------------------------------------------------------------------------------------------
+CameraModel readJsonModel(const std::vector<uchar>& data)
+{
+    if (data.empty())
+        throw std::runtime_error("The file is empty.");
+
+    // the views of a .views.json file are dropped while they are parsed
+    using ParseEvent = nlohmann::json::parse_event_t;
+    bool inViews = false;
+    const nlohmann::json camJson = nlohmann::json::parse(data.data(), data.data() + data.size(),
+        [&inViews](int depth, ParseEvent event, nlohmann::json& parsed) {
+            if (depth == 1 && event == ParseEvent::key)
+            {
+                inViews = parsed == "views";
+                return !inViews;
+            }
+            return !(depth == 2 && event == ParseEvent::object_end && inViews);
+        });
+
+    CameraModel model;
+    model.fx = camJson.at("fx").get<double>();
+    model.fy = camJson.at("fy").get<double>();
+    model.cx = camJson.at("cx").get<double>();
+    model.cy = camJson.at("cy").get<double>();
+    model.width
+        = toInt32(camJson.at("horizontal_resolution").get<double>(), "horizontal_resolution");
+    model.height
+        = toInt32(camJson.at("vertical_resolution").get<double>(), "vertical_resolution");
+
+    const nlohmann::json& errorJson = camJson.at("reprojection_error");
+    model.reprojectionError = errorJson.is_null()
+        ? jsonInvalidReprojectionError
+        : toFloat(errorJson.get<double>(), "reprojection_error");
+    setDistortion(model, camJson.at("distortion_coefficients").get<std::vector<double>>());
+    return model;
+}
+//-------------------------------------------------------------------------------------------------
+CameraModel readBcalModel(const std::string& filePath)
+{
+    const BcalFileView file(filePath);
+    const BcalHeader& header = file.getHeader();
+
+    CameraModel model;
+    model.fx = header.cameraMatrix[0];
+    model.fy = header.cameraMatrix[4];
+    model.cx = header.cameraMatrix[2];
+    model.cy = header.cameraMatrix[5];
+    model.width = header.imageWidth;
+    model.height = header.imageHeight;
+    model.reprojectionError = header.reprojectionError;
+
+    const size_t numCoefficients = std::min<size_t>(
+        header.numDistortionCoefficients, bcalMaxDistortionCoefficients);
+    setDistortion(
+        model, std::vector<double>(header.distortion, header.distortion + numCoefficients));
+    return model;
+}
+//-------------------------------------------------------------------------------------------------
+void checkModel(const CameraModel& model)
+{
+    bool finite = std::isfinite(model.fx) && std::isfinite(model.fy) && std::isfinite(model.cx)
+        && std::isfinite(model.cy);
+    for (size_t i = 0; i < model.numDistortionCoefficients; ++i)
+        finite = finite && std::isfinite(model.distortion[i]);
+
+    if (!finite)
+        throw std::runtime_error("The camera model contains invalid numbers.");
+    if (model.fx <= 0 || model.fy <= 0)
+        throw std::runtime_error("The focal length is not positive.");
+    if (model.width <= 0 || model.height <= 0)
+        throw std::runtime_error("The image size is not positive.");
+}
+} // namespace
+//-------------------------------------------------------------------------------------------------
+CameraModel loadCameraModel(const std::string& filePath)
+{
+    namespace fs = std::filesystem;
+    const auto extension = fs::path(filePath).extension().string();
+    if (extension != ".xml" && extension != ".json" && extension != ".bcal")
+        throw std::runtime_error("Unknown format of the camera parameters: " + filePath);
+
+    // the errors of BcalFileView already contain the file path
+    CameraModel model;
+    if (extension == ".bcal")
+        model = readBcalModel(filePath);
+
+    try
+    {
+        if (extension != ".bcal")
+        {
+            std::vector<uchar> data;
+            if (!readFileInto(filePath, data))
+                throw std::runtime_error("Could not read the file.");
+            model = extension == ".xml" ? readXmlModel(data) : readJsonModel(data);
+        }
+        checkModel(model);
+    }
+    catch (const std::exception& e)
+    {
+        // nlohmann::json throws std::logic_error and cv::FileStorage throws cv::Exception
+        throw std::runtime_error(filePath + ": " + e.what());
+    }
+    return model;
+}
+//-------------------------------------------------------------------------------------------------
+CameraModelSet loadCameraModels(const std::vector<std::string>& filePaths)
+{
+    CameraModelSet modelSet;
+    modelSet.models.resize(filePaths.size());
+    modelSet.errors.resize(filePaths.size());
+
+    // every entry of the set is written by one thread only, so no synchronization is needed
+    cv::parallel_for_(cv::Range(0, static_cast<int>(filePaths.size())),
+        [&filePaths, &modelSet](const cv::Range& range) {
+            for (int i = range.start; i < range.end; ++i)
+            {
+                try
+                {
+                    modelSet.models[i] = loadCameraModel(filePaths[i]);
+                }
+                catch (const std::exception& e)
+                {
+                    modelSet.errors[i] = e.what();
+                }
+            }
+        });
+
+    modelSet.numFailed = static_cast<size_t>(std::count_if(modelSet.errors.begin(),
+        modelSet.errors.end(), [](const std::string& error) { return !error.empty(); }));
+    return modelSet;
+}
+
+} // namespace libba
@@ -0,0 +1,356 @@
+/*
+ * DetectionJournal.cpp
+ *
+ *  Created on: 18.10.2026
+ */
+
+#include "camera_calibration/DetectionJournal.h"
+#include "camera_calibration/BcalFile.h"
+#include "camera_calibration/ImageArchive.h"
+#include "camera_calibration/utils.h"
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace libba
+{
+namespace
+{
+constexpr char journalMagic[8] = { 'C', 'C', 'J', 'R', 'N', 'L', '\r', '\n' };
+constexpr uint32_t journalVersion = 2;
+
+struct JournalHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t fingerprint;
+};
+
+struct RecordHeader
+{
+    uint32_t payloadSize;
+
+    /**
+     * CRC-32 of the payload.
+     */
+    uint32_t crc;
+};
+
+/**
+ * Start of the payload of a record, followed by the file path, the points and numLadderRungs
+ * LadderRecords.
+ */
+struct PayloadHeader
+{
+    uint64_t imageIdx;
+    int32_t imageWidth;
+    int32_t imageHeight;
+    BcalView view;
+    uint64_t fileSize;
+    int64_t modificationTime;
+    uint32_t numLadderRungs;
+    uint32_t reserved;
+};
+
+/**
+ * The statistics of a rung of the detection ladder for one image.
+ */
+struct LadderRecord
+{
+    uint32_t attempts;
+    uint32_t successes;
+    double totalTime;
+};
+
+static_assert(sizeof(JournalHeader) == 24, "JournalHeader must not contain padding.");
+static_assert(sizeof(PayloadHeader) == 152, "PayloadHeader must not contain padding.");
+static_assert(sizeof(LadderRecord) == 16, "LadderRecord must not contain padding.");
+
+/**
+ * Records with a larger payload can only be damaged.
+ */
+constexpr uint32_t maxPayloadSize = 64 << 20;
+
+uint32_t computeCrc32(const unsigned char* data, const size_t size)
+{
+    // table of the reflected polynomial of zlib and PNG
+    static const std::array<uint32_t, 256> table = [] {
+        std::array<uint32_t, 256> values;
+        for (uint32_t i = 0; i < 256; ++i)
+        {
+            uint32_t value = i;
+            for (int bit = 0; bit < 8; ++bit)
+                value = (value & 1) ? 0xEDB88320u ^ (value >> 1) : value >> 1;
+            values[i] = value;
+        }
+        return values;
+    }();
+
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < size; ++i)
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return crc ^ 0xFFFFFFFFu;
+}
+//-------------------------------------------------------------------------------------------------
+/**
+ * Reads the size and modification time of an image file, of the archive for members of
+ * archives. Both are 0 if the file does not exist.
+ */
+void readFileStamp(const std::string& filePath, uint64_t& fileSize, int64_t& modificationTime)
+{
+    std::string archivePath, memberName;
+    const std::string& path
+        = splitArchivePath(filePath, archivePath, memberName) ? archivePath : filePath;
+
+    struct stat fileStatus;
+    if (::stat(path.c_str(), &fileStatus) != 0)
+    {
+        fileSize = 0;
+        modificationTime = 0;
+        return;
+    }
+    fileSize = static_cast<uint64_t>(fileStatus.st_size);
+    modificationTime = static_cast<int64_t>(fileStatus.st_mtime);
+}
+//-------------------------------------------------------------------------------------------------
+void syncFileData(const int fd)
+{
+#ifdef __APPLE__
+    ::fsync(fd);
+#else
+    ::fdatasync(fd);
+#endif
+}
+} // namespace
+//-------------------------------------------------------------------------------------------------
+DetectionJournal::DetectionJournal(const std::string& filePath, const uint64_t fingerprint,
+    const bool resume, const size_t syncInterval)
+    : filePath(filePath)
+    , fd(-1)
+    , syncInterval(std::max<size_t>(syncInterval, 1))
+    , unsyncedRecords(0)
+{
+    // a missing journal is started like a journal of other settings
+    std::vector<unsigned char> data;
+    if (resume && !readFileInto(filePath, data))
+        data.clear();
+
+    fd = ::open(filePath.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0)
+        throw std::runtime_error("Could not open the journal: " + filePath);
+
+    JournalHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, journalMagic, sizeof(journalMagic));
+    header.version = journalVersion;
+    header.fingerprint = fingerprint;
+
+    size_t validSize = 0;
+    if (data.size() >= sizeof(header) && std::memcmp(data.data(), &header, sizeof(header)) == 0)
+        validSize = readEntries(data);
+
+    // the damaged tail of a crashed run is removed, new records are appended after the valid ones
+    const off_t offset = static_cast<off_t>(validSize);
+    if (::ftruncate(fd, offset) != 0 || ::lseek(fd, offset, SEEK_SET) != offset)
+    {
+        ::close(fd);
+        throw std::runtime_error("Could not truncate the journal: " + filePath);
+    }
+
+    if (validSize == 0)
+    {
+        try
+        {
+            write(reinterpret_cast<const unsigned char*>(&header), sizeof(header));
+        }
+        catch (...)
+        {
+            ::close(fd);
+            throw;
+        }
+        syncFileData(fd);
+    }
+}
+//-------------------------------------------------------------------------------------------------
+DetectionJournal::~DetectionJournal()
+{
+    if (fd < 0)
+        return;
+
+    sync();
+    ::close(fd);
+}
+//-------------------------------------------------------------------------------------------------
+const std::vector<DetectionJournal::Entry>& DetectionJournal::getEntries() const
+{
+    return entries;
+}
+//-------------------------------------------------------------------------------------------------
+size_t DetectionJournal::readEntries(const std::vector<unsigned char>& data)
+{
+    size_t offset = sizeof(JournalHeader);
+    while (data.size() - offset >= sizeof(RecordHeader))
+    {
+        RecordHeader recordHeader;
+        std::memcpy(&recordHeader, &data[offset], sizeof(recordHeader));
+        const unsigned char* payload = &data[offset + sizeof(recordHeader)];
+        const size_t payloadSize = recordHeader.payloadSize;
+        if (payloadSize < sizeof(PayloadHeader) || payloadSize > maxPayloadSize
+            || payloadSize > data.size() - offset - sizeof(recordHeader)
+            || computeCrc32(payload, payloadSize) != recordHeader.crc)
+            break;
+
+        PayloadHeader payloadHeader;
+        std::memcpy(&payloadHeader, payload, sizeof(payloadHeader));
+        const BcalView& view = payloadHeader.view;
+        if (sizeof(payloadHeader) + view.pathLength + size_t(view.numPoints) * sizeof(BcalPoint)
+                + size_t(payloadHeader.numLadderRungs) * sizeof(LadderRecord)
+            != payloadSize)
+            break;
+
+        Entry entry;
+        entry.imageIdx = payloadHeader.imageIdx;
+        entry.imageSize = cv::Size2i(payloadHeader.imageWidth, payloadHeader.imageHeight);
+        entry.fileSize = payloadHeader.fileSize;
+        entry.modificationTime = payloadHeader.modificationTime;
+        readBcalView(view, entry.info);
+
+        const char* path = reinterpret_cast<const char*>(payload + sizeof(payloadHeader));
+        entry.info.filePath.assign(path, view.pathLength);
+
+        const unsigned char* pointData = payload + sizeof(payloadHeader) + view.pathLength;
+        entry.info.boardCornersImg.resize(view.numPoints);
+        entry.info.pointIds.resize(view.numPoints);
+        for (size_t i = 0; i < view.numPoints; ++i)
+        {
+            BcalPoint point;
+            std::memcpy(&point, pointData + i * sizeof(BcalPoint), sizeof(point));
+            entry.info.boardCornersImg[i] = cv::Point2f(point.x, point.y);
+            entry.info.pointIds[i] = point.id;
+        }
+
+        const unsigned char* ladderData = pointData + size_t(view.numPoints) * sizeof(BcalPoint);
+        entry.ladderStatistics.resize(payloadHeader.numLadderRungs);
+        for (size_t i = 0; i < payloadHeader.numLadderRungs; ++i)
+        {
+            LadderRecord ladderRecord;
+            std::memcpy(&ladderRecord, ladderData + i * sizeof(LadderRecord), sizeof(ladderRecord));
+            entry.ladderStatistics[i].attempts = ladderRecord.attempts;
+            entry.ladderStatistics[i].successes = ladderRecord.successes;
+            entry.ladderStatistics[i].totalTime = ladderRecord.totalTime;
+        }
+
+        entries.push_back(std::move(entry));
+        offset += sizeof(recordHeader) + payloadSize;
+    }
+    return offset;
+}
+//-------------------------------------------------------------------------------------------------
+bool DetectionJournal::isFileUnchanged(const Entry& entry) const
+{
+    uint64_t fileSize;
+    int64_t modificationTime;
+    readFileStamp(entry.info.filePath, fileSize, modificationTime);
+    return fileSize != 0 && fileSize == entry.fileSize
+        && modificationTime == entry.modificationTime;
+}
+//-------------------------------------------------------------------------------------------------
+void DetectionJournal::append(const size_t imageIdx, const cv::Size2i& imageSize,
+    const CameraCalibration::CalibImgInfo& info,
+    const std::vector<CameraCalibration::StrategyStatistics>& ladderStatistics)
+{
+    PayloadHeader payloadHeader;
+    std::memset(&payloadHeader, 0, sizeof(payloadHeader));
+    payloadHeader.imageIdx = imageIdx;
+    payloadHeader.imageWidth = imageSize.width;
+    payloadHeader.imageHeight = imageSize.height;
+    payloadHeader.view = makeBcalView(info);
+    payloadHeader.view.pathLength = static_cast<uint32_t>(info.filePath.size());
+    payloadHeader.view.numPoints = static_cast<uint32_t>(info.boardCornersImg.size());
+    readFileStamp(info.filePath, payloadHeader.fileSize, payloadHeader.modificationTime);
+    payloadHeader.numLadderRungs = static_cast<uint32_t>(ladderStatistics.size());
+
+    const size_t payloadSize = sizeof(payloadHeader) + info.filePath.size()
+        + info.boardCornersImg.size() * sizeof(BcalPoint)
+        + ladderStatistics.size() * sizeof(LadderRecord);
+    record.resize(sizeof(RecordHeader) + payloadSize);
+    unsigned char* payload = record.data() + sizeof(RecordHeader);
+    std::memcpy(payload, &payloadHeader, sizeof(payloadHeader));
+    std::memcpy(payload + sizeof(payloadHeader), info.filePath.data(), info.filePath.size());
+
+    unsigned char* pointData = payload + sizeof(payloadHeader) + info.filePath.size();
+    for (size_t i = 0; i < info.boardCornersImg.size(); ++i)
+    {
+        BcalPoint point;
+        std::memset(&point, 0, sizeof(point));
+        point.x = info.boardCornersImg[i].x;
+        point.y = info.boardCornersImg[i].y;
+        point.id = i < info.pointIds.size() ? info.pointIds[i] : static_cast<int32_t>(i);
+        std::memcpy(pointData + i * sizeof(BcalPoint), &point, sizeof(point));
+    }
+
+    unsigned char* ladderData = pointData + info.boardCornersImg.size() * sizeof(BcalPoint);
+    for (size_t i = 0; i < ladderStatistics.size(); ++i)
+    {
+        LadderRecord ladderRecord;
+        ladderRecord.attempts = static_cast<uint32_t>(ladderStatistics[i].attempts);
+        ladderRecord.successes = static_cast<uint32_t>(ladderStatistics[i].successes);
+        ladderRecord.totalTime = ladderStatistics[i].totalTime;
+        std::memcpy(ladderData + i * sizeof(LadderRecord), &ladderRecord, sizeof(ladderRecord));
+    }
+
+    RecordHeader recordHeader;
+    recordHeader.payloadSize = static_cast<uint32_t>(payloadSize);
+    recordHeader.crc = computeCrc32(payload, payloadSize);
+    std::memcpy(record.data(), &recordHeader, sizeof(recordHeader));
+
+    // the record is in the page cache after write(), the sync is only needed against power loss
+    write(record.data(), record.size());
+    if (++unsyncedRecords >= syncInterval)
+        sync();
+}
+//-------------------------------------------------------------------------------------------------
+void DetectionJournal::sync()
+{
+    if (unsyncedRecords == 0 || fd < 0)
+        return;
+
+    syncFileData(fd);
+    unsyncedRecords = 0;
+}
+//-------------------------------------------------------------------------------------------------
+void DetectionJournal::remove()
+{
+    if (fd < 0)
+        return;
+
+    ::close(fd);
+    fd = -1;
+    unsyncedRecords = 0;
+
+    // a journal which can not be removed is harmless, its records are only used for unchanged
+    // files
+    ::unlink(filePath.c_str());
+}
+//-------------------------------------------------------------------------------------------------
+void DetectionJournal::write(const unsigned char* data, const size_t size)
+{
+    size_t written = 0;
+    while (written < size)
+    {
+        const ssize_t result = ::write(fd, data + written, size - written);
+        if (result < 0 && errno == EINTR)
+            continue;
+        if (result <= 0)
+            throw std::runtime_error("Could not write the journal: " + filePath);
+        written += static_cast<size_t>(result);
+    }
+}
+
+} // namespace libba
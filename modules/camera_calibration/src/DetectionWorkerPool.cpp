@@ -0,0 +1,169 @@
+/*
+ * DetectionWorkerPool.cpp
+ *
+ *  Created on: 18.10.2026
+ */
+
+#include "camera_calibration/DetectionWorkerPool.h"
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+namespace libba
+{
+namespace
+{
+/**
+ * Interval in which a caller which waits for a free worker checks for a stop request.
+ */
+constexpr std::chrono::milliseconds stopCheckInterval(50);
+} // namespace
+//-------------------------------------------------------------------------------------------------
+DetectionWorkerPool::DetectionWorkerPool(const size_t maxWorkers)
+    : maxWorkers(std::max<size_t>(maxWorkers, 1))
+    , busyWorkers(0)
+    , shutdown(false)
+    , slotFound(false)
+    , slotBusy(false)
+{
+}
+//-------------------------------------------------------------------------------------------------
+DetectionWorkerPool::~DetectionWorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        shutdown = true;
+        jobs.clear();
+    }
+    jobAdded.notify_all();
+    slotStarted.notify_all();
+
+    for (auto& thread : threads)
+        thread.join();
+    if (slotThread.joinable())
+        slotThread.join();
+}
+//-------------------------------------------------------------------------------------------------
+bool DetectionWorkerPool::run(Job job, const std::atomic<bool>& stopRequested)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (busyWorkers >= maxWorkers)
+    {
+        if (stopRequested)
+            return false;
+        jobFinished.wait_for(lock, stopCheckInterval);
+    }
+
+    // the workers are started when they are needed for the first time
+    ++busyWorkers;
+    if (threads.size() < busyWorkers)
+        threads.emplace_back(&DetectionWorkerPool::work, this);
+
+    jobs.push_back(std::move(job));
+    lock.unlock();
+    jobAdded.notify_one();
+    return true;
+}
+//-------------------------------------------------------------------------------------------------
+bool DetectionWorkerPool::detect(const cv::Mat& img, const Detector& detector,
+    std::vector<cv::Point2f>& points, std::vector<int>& pointIds,
+    const std::atomic<bool>& stopRequested)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+
+    // a detection which was abandoned after a stop request still uses the slot
+    while (slotBusy)
+    {
+        if (stopRequested)
+            return false;
+        jobFinished.wait_for(lock, stopCheckInterval);
+    }
+
+    if (!slotThread.joinable())
+        slotThread = std::thread(&DetectionWorkerPool::workOnSlot, this);
+
+    // the detectors only capture a few values, so copying them does not allocate memory
+    slotImage = img;
+    slotDetector = detector;
+    slotBusy = true;
+    slotStarted.notify_one();
+
+    while (slotBusy)
+    {
+        if (stopRequested)
+            return false;
+        jobFinished.wait_for(lock, stopCheckInterval);
+    }
+
+    if (slotError)
+        std::rethrow_exception(std::exchange(slotError, nullptr));
+    if (!slotFound)
+        return false;
+
+    // the vectors keep their capacity, so after the first images the copies do not allocate
+    points.assign(slotPoints.begin(), slotPoints.end());
+    pointIds.assign(slotIds.begin(), slotIds.end());
+    return true;
+}
+//-------------------------------------------------------------------------------------------------
+void DetectionWorkerPool::waitUntilIdle()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    jobFinished.wait(lock, [this]() { return busyWorkers == 0 && !slotBusy; });
+}
+//-------------------------------------------------------------------------------------------------
+void DetectionWorkerPool::work()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        jobAdded.wait(lock, [this]() { return shutdown || !jobs.empty(); });
+        if (shutdown)
+            return;
+
+        Job job = std::move(jobs.front());
+        jobs.pop_front();
+        lock.unlock();
+        job();
+        lock.lock();
+
+        --busyWorkers;
+        jobFinished.notify_all();
+    }
+}
+//-------------------------------------------------------------------------------------------------
+void DetectionWorkerPool::workOnSlot()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        slotStarted.wait(lock, [this]() { return shutdown || slotBusy; });
+        if (shutdown)
+            return;
+
+        // only the caller of detect() touches the slot while it is busy, and it waits for the
+        // detection or returns without reading the slot, so the detection runs unlocked
+        lock.unlock();
+        bool found = false;
+        std::exception_ptr error;
+        try
+        {
+            slotPoints.clear();
+            slotIds.clear();
+            found = slotDetector(slotImage, slotPoints, slotIds);
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+        lock.lock();
+
+        slotFound = found;
+        slotError = error;
+        slotImage.release();
+        slotBusy = false;
+        jobFinished.notify_all();
+    }
+}
+
+} // namespace libba
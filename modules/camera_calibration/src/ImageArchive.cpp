@@ -0,0 +1,465 @@
+/*
+ * ImageArchive.cpp
+ *
+ *  Created on: 18.10.2026
+ */
+
+#include "camera_calibration/ImageArchive.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <opencv2/imgcodecs.hpp>
+#include <stdexcept>
+#include <sys/stat.h>
+
+namespace libba
+{
+namespace
+{
+/**
+ * Separator between the path of an archive and the name of a member in a virtual path.
+ */
+constexpr char memberSeparator[] = "!/";
+
+constexpr size_t tarBlockSize = 512;
+
+// signatures of the zip records
+constexpr uint32_t zipLocalHeaderSignature = 0x04034b50;
+constexpr uint32_t zipCentralHeaderSignature = 0x02014b50;
+constexpr uint32_t zipEndSignature = 0x06054b50;
+constexpr uint32_t zip64EndSignature = 0x06064b50;
+constexpr uint32_t zip64LocatorSignature = 0x07064b50;
+
+/**
+ * Size of the end of central directory record without the comment, which has at most 65535
+ * bytes.
+ */
+constexpr size_t zipEndSize = 22;
+constexpr size_t zipMaxCommentSize = 0xFFFF;
+
+/**
+ * Archives which are currently mapped, see ImageArchive::open().
+ */
+struct CachedArchive
+{
+    std::shared_ptr<const ImageArchive> archive;
+    off_t size;
+    time_t modificationTime;
+};
+std::mutex archiveCacheMutex;
+std::unordered_map<std::string, CachedArchive> archiveCache;
+
+bool endsWithIgnoreCase(const std::string& str, const std::string& suffix)
+{
+    return str.size() >= suffix.size()
+        && std::equal(suffix.begin(), suffix.end(), str.end() - suffix.size(),
+            [](const char c1, const char c2) {
+                return std::tolower(static_cast<unsigned char>(c1))
+                    == std::tolower(static_cast<unsigned char>(c2));
+            });
+}
+//-------------------------------------------------------------------------------------------------
+uint16_t readLittleEndian16(const unsigned char* data)
+{
+    return uint16_t(data[0] | (data[1] << 8));
+}
+//-------------------------------------------------------------------------------------------------
+uint32_t readLittleEndian32(const unsigned char* data)
+{
+    return uint32_t(data[0]) | (uint32_t(data[1]) << 8) | (uint32_t(data[2]) << 16)
+        | (uint32_t(data[3]) << 24);
+}
+//-------------------------------------------------------------------------------------------------
+uint64_t readLittleEndian64(const unsigned char* data)
+{
+    return uint64_t(readLittleEndian32(data)) | (uint64_t(readLittleEndian32(data + 4)) << 32);
+}
+//-------------------------------------------------------------------------------------------------
+/**
+ * Returns a null terminated or fixed length string field of a tar header.
+ */
+std::string readTarString(const unsigned char* field, const size_t length)
+{
+    const char* str = reinterpret_cast<const char*>(field);
+    return std::string(str, strnlen(str, length));
+}
+//-------------------------------------------------------------------------------------------------
+/**
+ * Parses a numeric field of a tar header, which is an octal number or, for large values, a big
+ * endian binary number marked by the highest bit of the first byte.
+ */
+uint64_t readTarNumber(const unsigned char* field, const size_t length)
+{
+    uint64_t value = 0;
+    if (field[0] & 0x80)
+    {
+        value = field[0] & 0x7F;
+        for (size_t i = 1; i < length; ++i)
+            value = (value << 8) | field[i];
+        return value;
+    }
+
+    size_t i = 0;
+    while (i < length && (field[i] == ' ' || field[i] == 0))
+        ++i;
+    for (; i < length && field[i] >= '0' && field[i] <= '7'; ++i)
+        value = value * 8 + (field[i] - '0');
+    return value;
+}
+//-------------------------------------------------------------------------------------------------
+/**
+ * The checksum of a tar header is the sum of its bytes with the checksum field set to spaces.
+ */
+bool hasValidTarChecksum(const unsigned char* header)
+{
+    uint64_t sum = 0;
+    for (size_t i = 0; i < tarBlockSize; ++i)
+        sum += (i >= 148 && i < 156) ? ' ' : header[i];
+    return sum == readTarNumber(header + 148, 8);
+}
+//-------------------------------------------------------------------------------------------------
+/**
+ * Reads the records "<length> <key>=<value>\n" of a pax extended header and returns the value of
+ * key or an empty string.
+ */
+std::string readPaxRecord(const unsigned char* data, const size_t size, const std::string& key)
+{
+    const std::string records(reinterpret_cast<const char*>(data), size);
+    size_t pos = 0;
+    while (pos < records.size())
+    {
+        const size_t space = records.find(' ', pos);
+        if (space == std::string::npos)
+            break;
+        const size_t length = std::strtoull(records.c_str() + pos, nullptr, 10);
+        if (length == 0 || pos + length > records.size())
+            break;
+
+        const size_t equals = records.find('=', space);
+        if (equals != std::string::npos && equals < pos + length
+            && records.compare(space + 1, equals - space - 1, key) == 0)
+            return records.substr(equals + 1, pos + length - equals - 2);
+        pos += length;
+    }
+    return "";
+}
+} // namespace
+
+ImageArchive::ImageArchive(const std::string& archivePath)
+    : path(archivePath)
+    , file(archivePath)
+    , data(file.getData())
+    , size(file.getSize())
+{
+    if (endsWithIgnoreCase(archivePath, ".zip"))
+        indexZip();
+    else
+        indexTar();
+
+    for (size_t i = 0; i < members.size(); ++i)
+        memberIndex.emplace(members[i].name, i);
+
+    // the members are usually read in the order in which they are stored
+    file.adviseSequential();
+}
+//-------------------------------------------------------------------------------------------------
+ImageArchive::~ImageArchive() = default;
+//-------------------------------------------------------------------------------------------------
+std::shared_ptr<const ImageArchive> ImageArchive::open(const std::string& archivePath)
+{
+    struct stat fileStatus;
+    if (::stat(archivePath.c_str(), &fileStatus) != 0)
+        throw std::runtime_error("Could not open the archive: " + archivePath);
+
+    std::lock_guard<std::mutex> lock(archiveCacheMutex);
+    auto it = archiveCache.find(archivePath);
+    if (it != archiveCache.end() && it->second.size == fileStatus.st_size
+        && it->second.modificationTime == fileStatus.st_mtime)
+        return it->second.archive;
+
+    // the archive is indexed while the lock is held, so it is only indexed once
+    CachedArchive cached;
+    cached.archive = std::make_shared<const ImageArchive>(archivePath);
+    cached.size = fileStatus.st_size;
+    cached.modificationTime = fileStatus.st_mtime;
+    archiveCache[archivePath] = cached;
+    return cached.archive;
+}
+//-------------------------------------------------------------------------------------------------
+void ImageArchive::closeCachedArchives()
+{
+    std::lock_guard<std::mutex> lock(archiveCacheMutex);
+    archiveCache.clear();
+}
+//-------------------------------------------------------------------------------------------------
+bool ImageArchive::isArchive(const std::string& path)
+{
+    return endsWithIgnoreCase(path, ".tar") || endsWithIgnoreCase(path, ".zip");
+}
+//-------------------------------------------------------------------------------------------------
+const std::string& ImageArchive::getPath() const
+{
+    return path;
+}
+//-------------------------------------------------------------------------------------------------
+const std::vector<ImageArchive::Member>& ImageArchive::getMembers() const
+{
+    return members;
+}
+//-------------------------------------------------------------------------------------------------
+const ImageArchive::Member* ImageArchive::findMember(const std::string& name) const
+{
+    const auto it = memberIndex.find(name);
+    return it != memberIndex.end() ? &members[it->second] : nullptr;
+}
+//-------------------------------------------------------------------------------------------------
+std::vector<std::string> ImageArchive::getMemberPaths(
+    const std::vector<std::string>& extensions) const
+{
+    std::vector<std::string> paths;
+    for (const auto& member : members)
+    {
+        const bool matches = std::any_of(extensions.begin(), extensions.end(),
+            [&member](const std::string& e) { return endsWithIgnoreCase(member.name, e); });
+        if (matches)
+            paths.push_back(makeArchivePath(path, member.name));
+    }
+    return paths;
+}
+//-------------------------------------------------------------------------------------------------
+const unsigned char* ImageArchive::getBytes(const Member& member) const
+{
+    if (member.compressed)
+        throw std::runtime_error("The archive member is compressed, only uncompressed zip "
+                                 "archives (zip -0) are supported: "
+            + makeArchivePath(path, member.name));
+
+    return data + member.offset;
+}
+//-------------------------------------------------------------------------------------------------
+cv::Mat ImageArchive::getData(const Member& member) const
+{
+    // cv::Mat does not take const data, the matrix is only read by the decoders
+    return cv::Mat(1, static_cast<int>(member.size), CV_8UC1,
+        const_cast<unsigned char*>(getBytes(member)));
+}
+//-------------------------------------------------------------------------------------------------
+void ImageArchive::indexTar()
+{
+    // name and size of the next member from a GNU long name or a pax extended header
+    std::string nextName;
+    uint64_t nextSize = 0;
+    bool hasNextSize = false;
+
+    if (size < tarBlockSize)
+        throw std::runtime_error("Damaged tar archive: " + path);
+
+    size_t offset = 0;
+    while (offset + tarBlockSize <= size)
+    {
+        const unsigned char* header = data + offset;
+
+        // the archive ends with empty blocks
+        const auto isZero = [](const unsigned char c) { return c == 0; };
+        if (std::all_of(header, header + tarBlockSize, isZero))
+            break;
+        if (!hasValidTarChecksum(header))
+            throw std::runtime_error("Damaged tar header in " + path);
+
+        const uint64_t memberSize = hasNextSize ? nextSize : readTarNumber(header + 124, 12);
+        const size_t dataOffset = offset + tarBlockSize;
+        if (memberSize > size - dataOffset)
+            throw std::runtime_error("The tar archive is truncated: " + path);
+
+        const char type = static_cast<char>(header[156]);
+        if (type == 'L')
+        {
+            nextName = readTarString(data + dataOffset, memberSize);
+        }
+        else if (type == 'x')
+        {
+            nextName = readPaxRecord(data + dataOffset, memberSize, "path");
+            const std::string sizeRecord = readPaxRecord(data + dataOffset, memberSize, "size");
+            hasNextSize = !sizeRecord.empty();
+            nextSize = hasNextSize ? std::strtoull(sizeRecord.c_str(), nullptr, 10) : 0;
+            if (nextSize > size - dataOffset)
+                throw std::runtime_error("The tar archive is truncated: " + path);
+        }
+        else
+        {
+            // only regular files are members, directories, links and global headers are skipped
+            if (type == '0' || type == '\0' || type == '7')
+            {
+                Member member;
+                member.name = nextName;
+                if (member.name.empty())
+                {
+                    member.name = readTarString(header, 100);
+                    const std::string prefix = readTarString(header + 345, 155);
+                    if (std::memcmp(header + 257, "ustar", 5) == 0 && !prefix.empty())
+                        member.name = prefix + "/" + member.name;
+                }
+                member.offset = dataOffset;
+                member.size = memberSize;
+                members.push_back(member);
+            }
+            nextName.clear();
+            hasNextSize = false;
+        }
+
+        offset = dataOffset + (memberSize + tarBlockSize - 1) / tarBlockSize * tarBlockSize;
+    }
+}
+//-------------------------------------------------------------------------------------------------
+void ImageArchive::indexZip()
+{
+    // the end of central directory record is followed by a comment of unknown length
+    if (size < zipEndSize)
+        throw std::runtime_error("Damaged zip archive: " + path);
+    size_t endOffset = size - zipEndSize;
+    const size_t minEndOffset = endOffset > zipMaxCommentSize ? endOffset - zipMaxCommentSize : 0;
+    while (readLittleEndian32(data + endOffset) != zipEndSignature)
+    {
+        if (endOffset == minEndOffset)
+            throw std::runtime_error("Damaged zip archive: " + path);
+        --endOffset;
+    }
+
+    const unsigned char* end = data + endOffset;
+    uint64_t numEntries = readLittleEndian16(end + 10);
+    uint64_t directoryOffset = readLittleEndian32(end + 16);
+
+    // zip64 archives store the real values in an additional record
+    if (numEntries == 0xFFFF || directoryOffset == 0xFFFFFFFF)
+    {
+        if (endOffset < 20 || readLittleEndian32(end - 20) != zip64LocatorSignature)
+            throw std::runtime_error("Damaged zip64 archive: " + path);
+        const uint64_t end64Offset = readLittleEndian64(end - 20 + 8);
+        if (end64Offset > size || 56 > size - end64Offset
+            || readLittleEndian32(data + end64Offset) != zip64EndSignature)
+            throw std::runtime_error("Damaged zip64 archive: " + path);
+        numEntries = readLittleEndian64(data + end64Offset + 32);
+        directoryOffset = readLittleEndian64(data + end64Offset + 48);
+    }
+
+    size_t offset = directoryOffset;
+    for (uint64_t i = 0; i < numEntries; ++i)
+    {
+        if (offset > size || 46 > size - offset
+            || readLittleEndian32(data + offset) != zipCentralHeaderSignature)
+            throw std::runtime_error("Damaged zip central directory: " + path);
+
+        const unsigned char* entry = data + offset;
+        const uint16_t flags = readLittleEndian16(entry + 8);
+        const uint16_t method = readLittleEndian16(entry + 10);
+        uint64_t compressedSize = readLittleEndian32(entry + 20);
+        uint64_t uncompressedSize = readLittleEndian32(entry + 24);
+        const uint16_t nameLength = readLittleEndian16(entry + 28);
+        const uint16_t extraLength = readLittleEndian16(entry + 30);
+        const uint16_t commentLength = readLittleEndian16(entry + 32);
+        uint64_t localOffset = readLittleEndian32(entry + 42);
+        if (46u + nameLength + extraLength > size - offset)
+            throw std::runtime_error("Damaged zip central directory: " + path);
+
+        // the zip64 extra field contains the values which do not fit into 32 bit
+        const unsigned char* extra = entry + 46 + nameLength;
+        for (size_t pos = 0; pos + 4 <= extraLength;)
+        {
+            const uint16_t id = readLittleEndian16(extra + pos);
+            const uint16_t length = readLittleEndian16(extra + pos + 2);
+            if (id == 0x0001)
+            {
+                size_t field = pos + 4;
+                const size_t fieldEnd = std::min<size_t>(field + length, extraLength);
+                if (uncompressedSize == 0xFFFFFFFF && field + 8 <= fieldEnd)
+                {
+                    uncompressedSize = readLittleEndian64(extra + field);
+                    field += 8;
+                }
+                if (compressedSize == 0xFFFFFFFF && field + 8 <= fieldEnd)
+                {
+                    compressedSize = readLittleEndian64(extra + field);
+                    field += 8;
+                }
+                if (localOffset == 0xFFFFFFFF && field + 8 <= fieldEnd)
+                    localOffset = readLittleEndian64(extra + field);
+                break;
+            }
+            pos += 4 + length;
+        }
+
+        const std::string name(reinterpret_cast<const char*>(entry + 46), nameLength);
+        offset += 46 + nameLength + extraLength + commentLength;
+
+        // directories
+        if (name.empty() || name.back() == '/')
+            continue;
+
+        // the data follows the local header, whose extra field can differ from the central one
+        if (localOffset > size || 30 > size - localOffset
+            || readLittleEndian32(data + localOffset) != zipLocalHeaderSignature)
+            throw std::runtime_error("Damaged zip member " + name + " in " + path);
+        const uint64_t dataOffset = localOffset + 30 + readLittleEndian16(data + localOffset + 26)
+            + readLittleEndian16(data + localOffset + 28);
+        if (dataOffset > size || compressedSize > size - dataOffset)
+            throw std::runtime_error("The zip archive is truncated: " + path);
+
+        Member member;
+        member.name = name;
+        member.offset = dataOffset;
+        member.size = compressedSize;
+        member.compressed = method != 0 || (flags & 0x1) || compressedSize != uncompressedSize;
+        members.push_back(member);
+    }
+}
+//-------------------------------------------------------------------------------------------------
+bool splitArchivePath(const std::string& path, std::string& archivePath, std::string& memberName)
+{
+    for (size_t pos = path.find(memberSeparator); pos != std::string::npos;
+         pos = path.find(memberSeparator, pos + 1))
+    {
+        if (ImageArchive::isArchive(path.substr(0, pos)))
+        {
+            archivePath = path.substr(0, pos);
+            memberName = path.substr(pos + std::strlen(memberSeparator));
+            return true;
+        }
+    }
+    return false;
+}
+//-------------------------------------------------------------------------------------------------
+std::string makeArchivePath(const std::string& archivePath, const std::string& memberName)
+{
+    return archivePath + memberSeparator + memberName;
+}
+//-------------------------------------------------------------------------------------------------
+bool isArchiveMemberPath(const std::string& path)
+{
+    std::string archivePath, memberName;
+    return splitArchivePath(path, archivePath, memberName);
+}
+//-------------------------------------------------------------------------------------------------
+cv::Mat decodeArchiveMember(const std::string& path, const int flags, cv::Mat* dst)
+{
+    std::string archivePath, memberName;
+    if (!splitArchivePath(path, archivePath, memberName))
+        return cv::Mat();
+
+    try
+    {
+        const std::shared_ptr<const ImageArchive> archive = ImageArchive::open(archivePath);
+        const ImageArchive::Member* member = archive->findMember(memberName);
+        if (member == nullptr)
+            return cv::Mat();
+        return dst ? cv::imdecode(archive->getData(*member), flags, dst)
+                   : cv::imdecode(archive->getData(*member), flags);
+    }
+    catch (const std::runtime_error&)
+    {
+        return cv::Mat();
+    }
+}
+
+} // namespace libba
@@ -0,0 +1,270 @@
+/*
+ * ImageHeader.cpp
+ *
+ *  Created on: 18.10.2026
+ */
+
+#include "camera_calibration/ImageHeader.h"
+#include "camera_calibration/ImageArchive.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <istream>
+#include <stdexcept>
+#include <vector>
+
+namespace libba
+{
+namespace
+{
+uint32_t readBigEndian32(const unsigned char* data)
+{
+    return (uint32_t(data[0]) << 24) | (uint32_t(data[1]) << 16) | (uint32_t(data[2]) << 8)
+        | uint32_t(data[3]);
+}
+//-------------------------------------------------------------------------------------------------
+uint16_t readBigEndian16(const unsigned char* data)
+{
+    return uint16_t((data[0] << 8) | data[1]);
+}
+//-------------------------------------------------------------------------------------------------
+uint32_t readTiff32(const unsigned char* data, const bool bigEndian)
+{
+    if (bigEndian)
+        return readBigEndian32(data);
+    return (uint32_t(data[3]) << 24) | (uint32_t(data[2]) << 16) | (uint32_t(data[1]) << 8)
+        | uint32_t(data[0]);
+}
+//-------------------------------------------------------------------------------------------------
+uint16_t readTiff16(const unsigned char* data, const bool bigEndian)
+{
+    return bigEndian ? readBigEndian16(data) : uint16_t((data[1] << 8) | data[0]);
+}
+//-------------------------------------------------------------------------------------------------
+/**
+ * Returns the orientation tag of the first IFD of an EXIF segment (APP1 without marker and
+ * length) or 1 if the segment does not contain it.
+ */
+int readExifOrientation(const std::vector<unsigned char>& segment)
+{
+    const size_t tiffStart = 6;
+    if (segment.size() < tiffStart + 8
+        || std::string(segment.begin(), segment.begin() + 4) != "Exif")
+        return 1;
+
+    const unsigned char* tiff = segment.data() + tiffStart;
+    const size_t tiffSize = segment.size() - tiffStart;
+    const bool bigEndian = tiff[0] == 'M' && tiff[1] == 'M';
+    if (!bigEndian && !(tiff[0] == 'I' && tiff[1] == 'I'))
+        return 1;
+
+    const uint32_t ifdOffset = readTiff32(&tiff[4], bigEndian);
+    if (ifdOffset > tiffSize || 2 > tiffSize - ifdOffset)
+        return 1;
+
+    const uint16_t numEntries = readTiff16(&tiff[ifdOffset], bigEndian);
+    for (size_t i = 0; i < numEntries; ++i)
+    {
+        // tag, type, count and value of 12 bytes each
+        const size_t entryOffset = ifdOffset + 2 + i * 12;
+        if (entryOffset > tiffSize || 12 > tiffSize - entryOffset)
+            break;
+
+        if (readTiff16(&tiff[entryOffset], bigEndian) == 0x0112)
+        {
+            const int orientation = readTiff16(&tiff[entryOffset + 8], bigEndian);
+            return orientation >= 1 && orientation <= 8 ? orientation : 1;
+        }
+    }
+    return 1;
+}
+//-------------------------------------------------------------------------------------------------
+/**
+ * Read-only stream buffer on memory, e.g. on a member of a mapped archive.
+ */
+class MemoryStreamBuffer : public std::streambuf
+{
+public:
+    MemoryStreamBuffer(const unsigned char* data, const size_t size)
+    {
+        // the get area is only read, std::streambuf has no const variant
+        char* begin = reinterpret_cast<char*>(const_cast<unsigned char*>(data));
+        setg(begin, begin, begin + size);
+    }
+
+protected:
+    pos_type seekoff(off_type offset, std::ios_base::seekdir direction,
+        std::ios_base::openmode) override
+    {
+        char* base = direction == std::ios_base::beg
+            ? eback()
+            : (direction == std::ios_base::cur ? gptr() : egptr());
+        if (offset < eback() - base || offset > egptr() - base)
+            return pos_type(off_type(-1));
+
+        setg(eback(), base + offset, egptr());
+        return pos_type(gptr() - eback());
+    }
+
+    pos_type seekpos(pos_type position, std::ios_base::openmode mode) override
+    {
+        return seekoff(off_type(position), std::ios_base::beg, mode);
+    }
+};
+//-------------------------------------------------------------------------------------------------
+bool readBytes(std::istream& stream, unsigned char* data, const size_t size)
+{
+    stream.read(reinterpret_cast<char*>(data), size);
+    return static_cast<size_t>(stream.gcount()) == size;
+}
+//-------------------------------------------------------------------------------------------------
+ImageHeader readPngHeader(std::istream& stream, const std::string& filePath)
+{
+    // signature (8 bytes) is followed by the IHDR chunk: length, type, width, height, bit depth,
+    // color type
+    std::array<unsigned char, 26> data;
+    stream.seekg(0);
+    if (!readBytes(stream, data.data(), data.size())
+        || std::string(reinterpret_cast<const char*>(&data[12]), 4) != "IHDR")
+        throw std::runtime_error("Damaged PNG header: " + filePath);
+
+    ImageHeader header;
+    header.format = ImageHeader::Format::PNG;
+    header.size.width = static_cast<int>(readBigEndian32(&data[16]));
+    header.size.height = static_cast<int>(readBigEndian32(&data[20]));
+
+    switch (data[25])
+    {
+    case 0: // grayscale
+        header.channels = 1;
+        break;
+    case 2: // rgb
+        header.channels = 3;
+        break;
+    case 3: // palette
+        header.channels = 3;
+        break;
+    case 4: // grayscale with alpha
+        header.channels = 2;
+        break;
+    case 6: // rgb with alpha
+        header.channels = 4;
+        break;
+    default:
+        throw std::runtime_error("Unknown PNG color type: " + filePath);
+    }
+    return header;
+}
+//-------------------------------------------------------------------------------------------------
+ImageHeader readJpegHeader(std::istream& stream, const std::string& filePath)
+{
+    // skip the segments until a start of frame segment is found, the EXIF segment comes before it
+    int orientation = 1;
+    stream.seekg(2);
+    unsigned char marker[2];
+    while (readBytes(stream, marker, 2))
+    {
+        if (marker[0] != 0xFF)
+            break;
+
+        // fill bytes
+        if (marker[1] == 0xFF)
+        {
+            stream.seekg(-1, std::ios::cur);
+            continue;
+        }
+
+        // markers without a length
+        if (marker[1] == 0x01 || (marker[1] >= 0xD0 && marker[1] <= 0xD7))
+            continue;
+
+        // start of scan or end of image before a start of frame
+        if (marker[1] == 0xDA || marker[1] == 0xD9)
+            break;
+
+        unsigned char lengthData[2];
+        if (!readBytes(stream, lengthData, 2))
+            break;
+        const uint16_t length = readBigEndian16(lengthData);
+        if (length < 2)
+            break;
+
+        // SOF0 - SOF15 except DHT (C4), JPG (C8) and DAC (CC)
+        const bool isStartOfFrame = marker[1] >= 0xC0 && marker[1] <= 0xCF && marker[1] != 0xC4
+            && marker[1] != 0xC8 && marker[1] != 0xCC;
+        if (isStartOfFrame)
+        {
+            // precision, height, width, number of components
+            unsigned char data[6];
+            if (!readBytes(stream, data, sizeof(data)))
+                break;
+
+            ImageHeader header;
+            header.format = ImageHeader::Format::JPEG;
+            header.size.height = readBigEndian16(&data[1]);
+            header.size.width = readBigEndian16(&data[3]);
+            header.channels = data[5];
+
+            // the decoder rotates images with the orientations 5 - 8 by 90 degrees
+            header.orientation = orientation;
+            if (orientation >= 5)
+                std::swap(header.size.width, header.size.height);
+            return header;
+        }
+
+        if (marker[1] == 0xE1)
+        {
+            std::vector<unsigned char> segment(length - 2);
+            if (!readBytes(stream, segment.data(), segment.size()))
+                break;
+            if (orientation == 1)
+                orientation = readExifOrientation(segment);
+            continue;
+        }
+
+        stream.seekg(length - 2, std::ios::cur);
+    }
+
+    throw std::runtime_error("Damaged JPEG header: " + filePath);
+}
+//-------------------------------------------------------------------------------------------------
+ImageHeader readImageHeader(std::istream& stream, const std::string& filePath)
+{
+    unsigned char signature[8];
+    if (!readBytes(stream, signature, sizeof(signature)))
+        throw std::runtime_error("The image is too small: " + filePath);
+
+    const unsigned char pngSignature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    if (std::equal(signature, signature + 8, pngSignature))
+        return readPngHeader(stream, filePath);
+
+    if (signature[0] == 0xFF && signature[1] == 0xD8)
+        return readJpegHeader(stream, filePath);
+
+    return ImageHeader();
+}
+} // namespace
+//-------------------------------------------------------------------------------------------------
+ImageHeader readImageHeader(const std::string& filePath)
+{
+    // members of archives are read from the mapped archive
+    std::string archivePath, memberName;
+    if (splitArchivePath(filePath, archivePath, memberName))
+    {
+        const std::shared_ptr<const ImageArchive> archive = ImageArchive::open(archivePath);
+        const ImageArchive::Member* member = archive->findMember(memberName);
+        if (member == nullptr)
+            throw std::runtime_error("The image does not exist in the archive: " + filePath);
+
+        MemoryStreamBuffer buffer(archive->getBytes(*member), member->size);
+        std::istream stream(&buffer);
+        return readImageHeader(stream, filePath);
+    }
+
+    std::ifstream stream(filePath, std::ios::binary);
+    if (!stream.is_open())
+        throw std::runtime_error("Could not open the image: " + filePath);
+    return readImageHeader(stream, filePath);
+}
+} // namespace libba
@@ -0,0 +1,70 @@
+/*
+ * ImageQuality.cpp
+ *
+ *  Created on: 18.10.2026
+ */
+
+#include "camera_calibration/ImageQuality.h"
+#include <algorithm>
+#include <opencv2/imgproc.hpp>
+
+namespace libba
+{
+namespace
+{
+/**
+ * Pixels with a value of at most minValue or at least maxValue count as clipped.
+ */
+constexpr int clippedMinValue = 2;
+constexpr int clippedMaxValue = 253;
+} // namespace
+
+cv::Mat createPreviewImage(const cv::Mat& img, const int maxSize)
+{
+    cv::Mat preview;
+    createPreviewImage(img, maxSize, preview);
+    return preview;
+}
+//-------------------------------------------------------------------------------------------------
+void createPreviewImage(const cv::Mat& img, const int maxSize, cv::Mat& preview)
+{
+    const int longerSide = std::max(img.cols, img.rows);
+    if (longerSide <= maxSize)
+    {
+        preview = img;
+        return;
+    }
+
+    const double scale = double(maxSize) / longerSide;
+    cv::resize(img, preview, cv::Size(), scale, scale, cv::INTER_AREA);
+}
+//-------------------------------------------------------------------------------------------------
+ImageQuality computeImageQuality(const cv::Mat& img)
+{
+    cv::Mat laplacian;
+    return computeImageQuality(img, laplacian);
+}
+//-------------------------------------------------------------------------------------------------
+ImageQuality computeImageQuality(const cv::Mat& img, cv::Mat& laplacian)
+{
+    ImageQuality quality;
+    if (img.empty())
+        return quality;
+
+    cv::Laplacian(img, laplacian, CV_16S);
+    cv::Scalar mean;
+    cv::Scalar stdDev;
+    cv::meanStdDev(laplacian, mean, stdDev);
+    quality.sharpness = static_cast<float>(stdDev[0] * stdDev[0]);
+
+    size_t clippedPixels = 0;
+    for (int y = 0; y < img.rows; ++y)
+    {
+        const uchar* row = img.ptr<uchar>(y);
+        for (int x = 0; x < img.cols; ++x)
+            clippedPixels += row[x] <= clippedMinValue || row[x] >= clippedMaxValue;
+    }
+    quality.clippedRatio = static_cast<float>(clippedPixels) / img.total();
+    return quality;
+}
+} // namespace libba
@@ -0,0 +1,148 @@
+/*
+ * JsonStreamWriter.cpp
+ *
+ *  Created on: 18.10.2026
+ */
+
+#include "camera_calibration/JsonStreamWriter.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+
+namespace libba
+{
+JsonStreamWriter::JsonStreamWriter(std::ostream& stream)
+    : stream(stream)
+    , afterKey(false)
+{
+}
+//-------------------------------------------------------------------------------------------------
+void JsonStreamWriter::beginValue()
+{
+    if (afterKey)
+    {
+        afterKey = false;
+        return;
+    }
+
+    if (!hasValue.empty())
+    {
+        if (hasValue.back())
+            stream.put(',');
+        hasValue.back() = true;
+    }
+}
+//-------------------------------------------------------------------------------------------------
+void JsonStreamWriter::startObject()
+{
+    beginValue();
+    stream.put('{');
+    hasValue.push_back(false);
+}
+//-------------------------------------------------------------------------------------------------
+void JsonStreamWriter::endObject()
+{
+    stream.put('}');
+    hasValue.pop_back();
+}
+//-------------------------------------------------------------------------------------------------
+void JsonStreamWriter::startArray()
+{
+    beginValue();
+    stream.put('[');
+    hasValue.push_back(false);
+}
+//-------------------------------------------------------------------------------------------------
+void JsonStreamWriter::endArray()
+{
+    stream.put(']');
+    hasValue.pop_back();
+}
+//-------------------------------------------------------------------------------------------------
+void JsonStreamWriter::key(const std::string& name)
+{
+    string(name);
+    stream.put(':');
+    afterKey = true;
+}
+//-------------------------------------------------------------------------------------------------
+void JsonStreamWriter::null()
+{
+    beginValue();
+    stream << "null";
+}
+//-------------------------------------------------------------------------------------------------
+void JsonStreamWriter::boolean(const bool value)
+{
+    beginValue();
+    stream << (value ? "true" : "false");
+}
+//-------------------------------------------------------------------------------------------------
+void JsonStreamWriter::numberInteger(const int64_t value)
+{
+    beginValue();
+    stream << value;
+}
+//-------------------------------------------------------------------------------------------------
+void JsonStreamWriter::numberFloat(const double value, const int precision)
+{
+    if (!std::isfinite(value))
+    {
+        null();
+        return;
+    }
+
+    // Unlike snprintf, which takes the decimal point from LC_NUMERIC, to_chars does not depend on
+    // the locale, and it does not depend on the formatting state of the stream either. More than
+    // 17 digits do not change a double.
+    char buffer[32];
+    const std::to_chars_result result = std::to_chars(buffer, buffer + sizeof(buffer), value,
+        std::chars_format::general, std::clamp(precision, 1, 17));
+    beginValue();
+    stream.write(buffer, result.ptr - buffer);
+}
+//-------------------------------------------------------------------------------------------------
+void JsonStreamWriter::string(const std::string& value)
+{
+    beginValue();
+    stream.put('"');
+    for (const char c : value)
+    {
+        switch (c)
+        {
+        case '"':
+            stream << "\\\"";
+            break;
+        case '\\':
+            stream << "\\\\";
+            break;
+        case '\n':
+            stream << "\\n";
+            break;
+        case '\r':
+            stream << "\\r";
+            break;
+        case '\t':
+            stream << "\\t";
+            break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20)
+            {
+                char buffer[8];
+                std::snprintf(buffer, sizeof(buffer), "\\u%04x", static_cast<unsigned char>(c));
+                stream << buffer;
+            }
+            else
+                stream.put(c);
+        }
+    }
+    stream.put('"');
+}
+//-------------------------------------------------------------------------------------------------
+void JsonStreamWriter::lineBreak()
+{
+    stream.put('\n');
+}
+
+} // namespace libba
@@ -0,0 +1,61 @@
+/*
+ * MappedFile.cpp
+ *
+ *  Created on: 18.10.2026
+ */
+
+#include "camera_calibration/MappedFile.h"
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace libba
+{
+MappedFile::MappedFile(const std::string& filePath)
+    : data(nullptr)
+    , size(0)
+{
+    const int fd = ::open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        throw std::runtime_error("Could not open the file: " + filePath);
+
+    struct stat fileStatus;
+    if (::fstat(fd, &fileStatus) != 0 || fileStatus.st_size == 0)
+    {
+        ::close(fd);
+        throw std::runtime_error("The file is empty: " + filePath);
+    }
+
+    size = static_cast<size_t>(fileStatus.st_size);
+    void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    // the mapping stays valid without the file descriptor
+    ::close(fd);
+    if (mapping == MAP_FAILED)
+        throw std::runtime_error("Could not map the file: " + filePath);
+    data = static_cast<const unsigned char*>(mapping);
+}
+//-------------------------------------------------------------------------------------------------
+MappedFile::~MappedFile()
+{
+    ::munmap(const_cast<unsigned char*>(data), size);
+}
+//-------------------------------------------------------------------------------------------------
+const unsigned char* MappedFile::getData() const
+{
+    return data;
+}
+//-------------------------------------------------------------------------------------------------
+size_t MappedFile::getSize() const
+{
+    return size;
+}
+//-------------------------------------------------------------------------------------------------
+void MappedFile::adviseSequential() const
+{
+    ::madvise(const_cast<unsigned char*>(data), size, MADV_SEQUENTIAL);
+}
+
+} // namespace libba
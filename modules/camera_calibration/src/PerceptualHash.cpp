@@ -0,0 +1,56 @@
+/*
+ * PerceptualHash.cpp
+ *
+ *  Created on: 18.10.2026
+ */
+
+#include "camera_calibration/PerceptualHash.h"
+#include <algorithm>
+#include <bitset>
+#include <opencv2/imgproc.hpp>
+
+namespace libba
+{
+uint64_t computeDifferenceHash(const cv::Mat& img)
+{
+    // the small image lives on the stack, cv::resize() keeps memory of the right size
+    uchar smallData[8 * 9];
+    cv::Mat small(8, 9, CV_8UC1, smallData);
+    cv::resize(img, small, cv::Size(9, 8), 0, 0, cv::INTER_AREA);
+
+    uint64_t hash = 0;
+    for (int y = 0; y < small.rows; ++y)
+    {
+        const uchar* row = small.ptr<uchar>(y);
+        for (int x = 0; x + 1 < small.cols; ++x)
+            hash = (hash << 1) | (row[x + 1] > row[x] ? 1 : 0);
+    }
+    return hash;
+}
+//-------------------------------------------------------------------------------------------------
+int hammingDistance(const uint64_t hash1, const uint64_t hash2)
+{
+    return static_cast<int>(std::bitset<64>(hash1 ^ hash2).count());
+}
+//-------------------------------------------------------------------------------------------------
+void PerceptualHashIndex::add(const uint64_t hash)
+{
+    hashes.push_back(hash);
+}
+//-------------------------------------------------------------------------------------------------
+void PerceptualHashIndex::clear()
+{
+    hashes.clear();
+}
+//-------------------------------------------------------------------------------------------------
+void PerceptualHashIndex::reserve(const size_t count)
+{
+    hashes.reserve(count);
+}
+//-------------------------------------------------------------------------------------------------
+bool PerceptualHashIndex::containsSimilar(const uint64_t hash, const int maxDistance) const
+{
+    return std::any_of(hashes.begin(), hashes.end(),
+        [hash, maxDistance](const uint64_t h) { return hammingDistance(hash, h) <= maxDistance; });
+}
+} // namespace libba
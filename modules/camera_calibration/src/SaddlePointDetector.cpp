@@ -0,0 +1,539 @@
+/*
+ * SaddlePointDetector.cpp
+ *
+ *  Created on: 18.10.2026
+ */
+
+#include "camera_calibration/SaddlePointDetector.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <map>
+#include <numeric>
+#include <opencv2/imgproc.hpp>
+#include <queue>
+#include <utility>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define CAMCALIB_HAVE_NEON
+#endif
+
+namespace libba
+{
+namespace detail
+{
+#ifdef CAMCALIB_HAVE_AVX2
+/**
+ * Computes the response of the pixels [begin, end) of a row with AVX2 and FMA and returns the
+ * first pixel which was not computed. Defined in SaddleResponseAvx2.cpp.
+ */
+int saddleResponseRowAvx2(const float* above, const float* row, const float* below,
+    float* response, const int begin, const int end);
+#endif
+} // namespace detail
+
+namespace
+{
+/**
+ * Standard deviation of the gaussian filter which is applied before the derivatives are computed.
+ */
+constexpr double smoothingSigma = 1.5;
+
+/**
+ * Number of rows of the image tiles which are processed by one thread.
+ */
+constexpr int responseTileRows = 64;
+
+/**
+ * Radius of the non-maximum suppression of the response.
+ */
+constexpr int nmsRadius = 3;
+
+/**
+ * Local maxima below this fraction of the global maximum of the response are ignored.
+ */
+constexpr float responseThresholdRatio = 0.05f;
+
+/**
+ * Radius and number of the samples of the circle around a candidate on which the intensity must
+ * change between dark and bright four times.
+ */
+constexpr float circleRadius = 5.f;
+constexpr int circleSamples = 16;
+
+/**
+ * Minimum difference between the brightest and the darkest sample on the circle.
+ */
+constexpr int minCircleContrast = 20;
+
+/**
+ * Maximum number of candidates per expected corner, the strongest are kept.
+ */
+constexpr size_t candidatesPerCorner = 4;
+
+/**
+ * Number of the strongest candidates which are tried as start of the grid.
+ */
+constexpr size_t maxGridSeeds = 16;
+
+/**
+ * Maximum distance between the predicted and the found position of a grid corner relative to
+ * the distance of the neighboring corners.
+ */
+constexpr float maxPredictionError = 0.3f;
+
+/**
+ * Maximum cosine of the angle between the two axes of the grid.
+ */
+constexpr double maxAxisCos = 0.9;
+
+using RowKernel = int (*)(const float*, const float*, const float*, float*, int, int);
+
+#ifdef CAMCALIB_HAVE_NEON
+int saddleResponseRowNeon(const float* above, const float* row, const float* below,
+    float* response, const int begin, const int end)
+{
+    const float32x4_t two = vdupq_n_f32(2.f);
+    const float32x4_t quarter = vdupq_n_f32(0.25f);
+    const float32x4_t zero = vdupq_n_f32(0.f);
+
+    int x = begin;
+    for (; x + 4 <= end; x += 4)
+    {
+        const float32x4_t center = vld1q_f32(row + x);
+        const float32x4_t fxx
+            = vmlsq_f32(vaddq_f32(vld1q_f32(row + x - 1), vld1q_f32(row + x + 1)), two, center);
+        const float32x4_t fyy
+            = vmlsq_f32(vaddq_f32(vld1q_f32(above + x), vld1q_f32(below + x)), two, center);
+        const float32x4_t fxy = vmulq_f32(quarter,
+            vaddq_f32(vsubq_f32(vld1q_f32(below + x + 1), vld1q_f32(below + x - 1)),
+                vsubq_f32(vld1q_f32(above + x - 1), vld1q_f32(above + x + 1))));
+
+        const float32x4_t saddle = vmlsq_f32(vmulq_f32(fxy, fxy), fxx, fyy);
+        vst1q_f32(response + x, vmaxq_f32(saddle, zero));
+    }
+    return x;
+}
+#endif
+//-------------------------------------------------------------------------------------------------
+void saddleResponseRowScalar(const float* above, const float* row, const float* below,
+    float* response, const int begin, const int end)
+{
+    for (int x = begin; x < end; ++x)
+    {
+        const float fxx = row[x - 1] + row[x + 1] - 2.f * row[x];
+        const float fyy = above[x] + below[x] - 2.f * row[x];
+        const float fxy = 0.25f * (below[x + 1] - below[x - 1] + above[x - 1] - above[x + 1]);
+        response[x] = std::max(fxy * fxy - fxx * fyy, 0.f);
+    }
+}
+//-------------------------------------------------------------------------------------------------
+/**
+ * Returns the fastest vector kernel which is supported by the CPU or nullptr if only the scalar
+ * kernel can be used.
+ */
+RowKernel selectRowKernel()
+{
+#ifdef CAMCALIB_HAVE_AVX2
+    if (cv::checkHardwareSupport(CV_CPU_AVX2) && cv::checkHardwareSupport(CV_CPU_FMA3))
+        return detail::saddleResponseRowAvx2;
+#endif
+#ifdef CAMCALIB_HAVE_NEON
+    return saddleResponseRowNeon;
+#else
+    return nullptr;
+#endif
+}
+//-------------------------------------------------------------------------------------------------
+/**
+ * Returns the offset of the maximum of a parabola through three samples, between -0.5 and 0.5.
+ */
+float parabolaPeak(const float left, const float center, const float right)
+{
+    const float denominator = left - 2.f * center + right;
+    if (denominator >= 0)
+        return 0;
+    return std::clamp(0.5f * (left - right) / denominator, -0.5f, 0.5f);
+}
+//-------------------------------------------------------------------------------------------------
+/**
+ * Checks if the intensity on a circle around the point changes between dark and bright exactly
+ * four times, like around the corner of a chessboard.
+ */
+bool hasCornerProfile(const cv::Mat& img, const cv::Point2f& point)
+{
+    int samples[circleSamples];
+    for (int i = 0; i < circleSamples; ++i)
+    {
+        const float angle = 2.f * float(CV_PI) * i / circleSamples;
+        const int x = cvRound(point.x + circleRadius * std::cos(angle));
+        const int y = cvRound(point.y + circleRadius * std::sin(angle));
+        if (x < 0 || y < 0 || x >= img.cols || y >= img.rows)
+            return false;
+        samples[i] = img.at<uchar>(y, x);
+    }
+
+    const auto [minSample, maxSample] = std::minmax_element(samples, samples + circleSamples);
+    if (*maxSample - *minSample < minCircleContrast)
+        return false;
+
+    const int threshold = (*minSample + *maxSample) / 2;
+    int changes = 0;
+    for (int i = 0; i < circleSamples; ++i)
+        changes += (samples[i] > threshold) != (samples[(i + 1) % circleSamples] > threshold);
+    return changes == 4;
+}
+//-------------------------------------------------------------------------------------------------
+/**
+ * Checks if two corners are neighbors along a row or column of the chessboard. The middle of such
+ * neighbors lies on the edge between a dark and a bright square, while the middle of diagonal
+ * neighbors lies inside a square.
+ */
+bool isGridEdge(const cv::Mat& img, const cv::Point2f& corner1, const cv::Point2f& corner2)
+{
+    const cv::Point2f middle = (corner1 + corner2) * 0.5f;
+    const cv::Point2f normal = cv::Point2f(corner1.y - corner2.y, corner2.x - corner1.x) * 0.25f;
+    const cv::Point sample1(cvRound(middle.x + normal.x), cvRound(middle.y + normal.y));
+    const cv::Point sample2(cvRound(middle.x - normal.x), cvRound(middle.y - normal.y));
+    const cv::Rect imgRect(0, 0, img.cols, img.rows);
+    if (!imgRect.contains(sample1) || !imgRect.contains(sample2))
+        return false;
+
+    return std::abs(int(img.at<uchar>(sample1)) - int(img.at<uchar>(sample2)))
+        >= minCircleContrast;
+}
+//-------------------------------------------------------------------------------------------------
+/**
+ * Finds the local maxima of the response which look like chessboard corners, sorted by their
+ * response in descending order.
+ */
+std::vector<cv::Point2f> findCandidates(
+    const cv::Mat& img, const cv::Mat& response, const size_t maxCandidates)
+{
+    double maxResponse = 0;
+    cv::minMaxLoc(response, nullptr, &maxResponse);
+    if (maxResponse <= 0)
+        return std::vector<cv::Point2f>();
+
+    cv::Mat localMax;
+    cv::dilate(response, localMax,
+        cv::getStructuringElement(cv::MORPH_RECT, cv::Size(2 * nmsRadius + 1, 2 * nmsRadius + 1)));
+
+    const float threshold = responseThresholdRatio * float(maxResponse);
+    std::vector<std::pair<float, cv::Point2f> > maxima;
+    for (int y = nmsRadius; y < response.rows - nmsRadius; ++y)
+    {
+        const float* above = response.ptr<float>(y - 1);
+        const float* row = response.ptr<float>(y);
+        const float* below = response.ptr<float>(y + 1);
+        const float* rowMax = localMax.ptr<float>(y);
+        for (int x = nmsRadius; x < response.cols - nmsRadius; ++x)
+        {
+            if (row[x] <= threshold || row[x] < rowMax[x])
+                continue;
+
+            const cv::Point2f point(x + parabolaPeak(row[x - 1], row[x], row[x + 1]),
+                y + parabolaPeak(above[x], row[x], below[x]));
+            if (hasCornerProfile(img, point))
+                maxima.emplace_back(row[x], point);
+        }
+    }
+
+    std::sort(maxima.begin(), maxima.end(),
+        [](const auto& maximum1, const auto& maximum2) { return maximum1.first > maximum2.first; });
+    if (maxima.size() > maxCandidates)
+        maxima.resize(maxCandidates);
+
+    std::vector<cv::Point2f> candidates;
+    candidates.reserve(maxima.size());
+    for (const auto& maximum : maxima)
+        candidates.push_back(maximum.second);
+    return candidates;
+}
+//-------------------------------------------------------------------------------------------------
+/**
+ * Returns the index of the unused candidate which is closest to the position or -1 if no
+ * candidate is closer than maxDistance.
+ */
+int findClosestCandidate(const std::vector<cv::Point2f>& candidates,
+    const std::vector<bool>& used, const cv::Point2f& position, const float maxDistance)
+{
+    int closest = -1;
+    float closestDistance = maxDistance * maxDistance;
+    for (size_t i = 0; i < candidates.size(); ++i)
+    {
+        if (used[i])
+            continue;
+
+        const cv::Point2f diff = candidates[i] - position;
+        const float distance = diff.dot(diff);
+        if (distance < closestDistance)
+        {
+            closestDistance = distance;
+            closest = static_cast<int>(i);
+        }
+    }
+    return closest;
+}
+//-------------------------------------------------------------------------------------------------
+/**
+ * Grows a grid of candidates from the seed. Every cell of the grid is predicted from its
+ * neighbors and assigned to the closest candidate. Returns the grid cells with the index of their
+ * candidate.
+ */
+std::map<std::pair<int, int>, int> growGrid(const cv::Mat& img,
+    const std::vector<cv::Point2f>& candidates, const size_t seed, const int maxExtent)
+{
+    using Cell = std::pair<int, int>;
+    std::map<Cell, int> grid;
+
+    // the first steps along the axes go to the two closest neighbors along a row or column which
+    // are not on the same line, the angle between the axes can be far from perpendicular
+    std::vector<size_t> neighbors(candidates.size());
+    std::iota(neighbors.begin(), neighbors.end(), 0);
+    const auto distance
+        = [&](const size_t idx) { return cv::norm(candidates[idx] - candidates[seed]); };
+    const size_t numNeighbors = std::min<size_t>(9, neighbors.size());
+    std::partial_sort(neighbors.begin(), neighbors.begin() + numNeighbors, neighbors.end(),
+        [&](const size_t idx1, const size_t idx2) { return distance(idx1) < distance(idx2); });
+
+    // neighbors[0] is the seed itself
+    int first = -1;
+    int second = -1;
+    for (size_t n = 1; n < numNeighbors && second < 0; ++n)
+    {
+        const int idx = static_cast<int>(neighbors[n]);
+        if (!isGridEdge(img, candidates[seed], candidates[idx]))
+            continue;
+
+        if (first < 0)
+        {
+            first = idx;
+            continue;
+        }
+
+        const cv::Point2f stepI = candidates[first] - candidates[seed];
+        const cv::Point2f stepJ = candidates[idx] - candidates[seed];
+        const double cosAngle = std::abs(stepI.dot(stepJ)) / (cv::norm(stepI) * cv::norm(stepJ));
+        if (cosAngle < maxAxisCos)
+            second = idx;
+    }
+    if (second < 0)
+        return grid;
+
+    std::vector<bool> used(candidates.size(), false);
+    const auto addCell = [&](const Cell& cell, const int idx) {
+        grid[cell] = idx;
+        used[idx] = true;
+    };
+    addCell(Cell(0, 0), static_cast<int>(seed));
+    addCell(Cell(1, 0), first);
+    addCell(Cell(0, 1), second);
+
+    std::queue<Cell> cells;
+    cells.push(Cell(0, 0));
+    cells.push(Cell(1, 0));
+    cells.push(Cell(0, 1));
+
+    int minI = 0, maxI = 1, minJ = 0, maxJ = 1;
+    const Cell directions[] = { Cell(1, 0), Cell(-1, 0), Cell(0, 1), Cell(0, -1) };
+    while (!cells.empty())
+    {
+        const Cell cell = cells.front();
+        cells.pop();
+        const cv::Point2f& position = candidates[grid.at(cell)];
+
+        for (const Cell& direction : directions)
+        {
+            const Cell target(cell.first + direction.first, cell.second + direction.second);
+            if (grid.count(target))
+                continue;
+
+            // extrapolate along the direction or use the step of a parallel neighbor
+            const Cell back(cell.first - direction.first, cell.second - direction.second);
+            const Cell side1(cell.first + direction.second, cell.second + direction.first);
+            const Cell side2(cell.first - direction.second, cell.second - direction.first);
+            const Cell side1Target(side1.first + direction.first, side1.second + direction.second);
+            const Cell side2Target(side2.first + direction.first, side2.second + direction.second);
+
+            cv::Point2f step;
+            if (grid.count(back))
+                step = position - candidates[grid.at(back)];
+            else if (grid.count(side1) && grid.count(side1Target))
+                step = candidates[grid.at(side1Target)] - candidates[grid.at(side1)];
+            else if (grid.count(side2) && grid.count(side2Target))
+                step = candidates[grid.at(side2Target)] - candidates[grid.at(side2)];
+            else
+                continue;
+
+            const int idx = findClosestCandidate(candidates, used, position + step,
+                maxPredictionError * static_cast<float>(cv::norm(step)));
+            if (idx < 0)
+                continue;
+
+            addCell(target, idx);
+            cells.push(target);
+            minI = std::min(minI, target.first);
+            maxI = std::max(maxI, target.first);
+            minJ = std::min(minJ, target.second);
+            maxJ = std::max(maxJ, target.second);
+
+            // the grid contains wrong corners if it becomes larger than the pattern
+            if (maxI - minI >= maxExtent || maxJ - minJ >= maxExtent)
+                return std::map<Cell, int>();
+        }
+    }
+    return grid;
+}
+//-------------------------------------------------------------------------------------------------
+/**
+ * Converts a grid into corners in the order of cv::findChessboardCorners(): row by row with
+ * patternSize.width corners per row, the rows going clockwise in the image and the first corner
+ * in the upper left half of the image. If the grid contains wrong corners around the pattern, the
+ * complete window of the pattern size with the strongest corners is used.
+ */
+bool orderGridCorners(const std::map<std::pair<int, int>, int>& grid,
+    const std::vector<cv::Point2f>& candidates, const cv::Size2i& patternSize,
+    std::vector<cv::Point2f>& corners)
+{
+    if (grid.size() < static_cast<size_t>(patternSize.area()))
+        return false;
+
+    int minI = INT_MAX, maxI = INT_MIN, minJ = INT_MAX, maxJ = INT_MIN;
+    for (const auto& [cell, idx] : grid)
+    {
+        minI = std::min(minI, cell.first);
+        maxI = std::max(maxI, cell.first);
+        minJ = std::min(minJ, cell.second);
+        maxJ = std::max(maxJ, cell.second);
+    }
+
+    // the window is searched in both orientations, the candidates are sorted by their response,
+    // so the window with the lowest sum of candidate indices has the strongest corners
+    bool found = false;
+    bool bestTransposed = false;
+    std::pair<int, int> bestOrigin;
+    long bestScore = LONG_MAX;
+    for (const bool transposed : { false, true })
+    {
+        const int extentI = transposed ? patternSize.height : patternSize.width;
+        const int extentJ = transposed ? patternSize.width : patternSize.height;
+        for (int i0 = minI; i0 + extentI - 1 <= maxI; ++i0)
+            for (int j0 = minJ; j0 + extentJ - 1 <= maxJ; ++j0)
+            {
+                long score = 0;
+                for (int i = i0; i < i0 + extentI && score < LONG_MAX; ++i)
+                    for (int j = j0; j < j0 + extentJ; ++j)
+                    {
+                        const auto cell = grid.find(std::make_pair(i, j));
+                        if (cell == grid.end())
+                        {
+                            score = LONG_MAX;
+                            break;
+                        }
+                        score += cell->second;
+                    }
+
+                if (score < bestScore)
+                {
+                    found = true;
+                    bestScore = score;
+                    bestTransposed = transposed;
+                    bestOrigin = std::make_pair(i0, j0);
+                }
+            }
+    }
+    if (!found)
+        return false;
+
+    corners.clear();
+    corners.reserve(patternSize.area());
+    for (int row = 0; row < patternSize.height; ++row)
+        for (int col = 0; col < patternSize.width; ++col)
+        {
+            const std::pair<int, int> cell = bestTransposed
+                ? std::make_pair(bestOrigin.first + row, bestOrigin.second + col)
+                : std::make_pair(bestOrigin.first + col, bestOrigin.second + row);
+            corners.push_back(candidates[grid.at(cell)]);
+        }
+
+    // with the y axis pointing down, the rows must follow the row direction clockwise
+    const cv::Point2f rowStep = corners[1] - corners[0];
+    const cv::Point2f colStep = corners[patternSize.width] - corners[0];
+    if (rowStep.cross(colStep) < 0)
+        for (int row = 0; row < patternSize.height / 2; ++row)
+            std::swap_ranges(corners.begin() + row * patternSize.width,
+                corners.begin() + (row + 1) * patternSize.width,
+                corners.begin() + (patternSize.height - 1 - row) * patternSize.width);
+
+    // a rotation by 180 degrees keeps the orientation of the grid
+    if (corners.front().x + corners.front().y > corners.back().x + corners.back().y)
+        std::reverse(corners.begin(), corners.end());
+    return true;
+}
+} // namespace
+
+cv::Mat computeSaddleResponse(const cv::Mat& img)
+{
+    cv::Mat smoothed;
+    img.convertTo(smoothed, CV_32F);
+    cv::GaussianBlur(smoothed, smoothed, cv::Size(0, 0), smoothingSigma);
+
+    cv::Mat response = cv::Mat::zeros(img.size(), CV_32F);
+    if (img.rows < 3 || img.cols < 3)
+        return response;
+
+    static const RowKernel rowKernel = selectRowKernel();
+    const int numTiles = std::max(1, (img.rows - 2) / responseTileRows);
+    cv::parallel_for_(
+        cv::Range(1, img.rows - 1),
+        [&](const cv::Range& rows) {
+            for (int y = rows.start; y < rows.end; ++y)
+            {
+                const float* above = smoothed.ptr<float>(y - 1);
+                const float* row = smoothed.ptr<float>(y);
+                const float* below = smoothed.ptr<float>(y + 1);
+                float* responseRow = response.ptr<float>(y);
+
+                // the border pixels keep a response of zero
+                int x = 1;
+                if (rowKernel)
+                    x = rowKernel(above, row, below, responseRow, 1, img.cols - 1);
+                saddleResponseRowScalar(above, row, below, responseRow, x, img.cols - 1);
+            }
+        },
+        numTiles);
+    return response;
+}
+//-------------------------------------------------------------------------------------------------
+bool findChessboardCornersSaddle(
+    const cv::Mat& img, const cv::Size2i& patternSize, std::vector<cv::Point2f>& corners)
+{
+    corners.clear();
+    if (img.empty() || patternSize.width < 2 || patternSize.height < 2)
+        return false;
+
+    cv::Mat gray = img;
+    if (img.channels() == 3)
+        cv::cvtColor(img, gray, cv::COLOR_BGR2GRAY);
+
+    const cv::Mat response = computeSaddleResponse(gray);
+    const std::vector<cv::Point2f> candidates
+        = findCandidates(gray, response, candidatesPerCorner * patternSize.area());
+    if (candidates.size() < static_cast<size_t>(patternSize.area()))
+        return false;
+
+    // the grid can contain a wrong line of corners on every side of the pattern
+    const int maxExtent = std::max(patternSize.width, patternSize.height) + 2;
+    for (size_t seed = 0; seed < std::min(maxGridSeeds, candidates.size()); ++seed)
+    {
+        const auto grid = growGrid(gray, candidates, seed, maxExtent);
+        if (orderGridCorners(grid, candidates, patternSize, corners))
+            return true;
+    }
+
+    corners.clear();
+    return false;
+}
+} // namespace libba
@@ -0,0 +1,49 @@
+/*
+ * SaddleResponseAvx2.cpp
+ *
+ *  Created on: 18.10.2026
+ *
+ * AVX2 kernel of the saddle point response. This file is compiled with -mavx2 -mfma and its
+ * function is only called if the CPU supports both instruction sets.
+ */
+
+#include <immintrin.h>
+
+namespace libba
+{
+namespace detail
+{
+int saddleResponseRowAvx2(const float* above, const float* row, const float* below,
+    float* response, const int begin, const int end)
+{
+    const __m256 two = _mm256_set1_ps(2.f);
+    const __m256 quarter = _mm256_set1_ps(0.25f);
+    const __m256 zero = _mm256_setzero_ps();
+
+    int x = begin;
+    for (; x + 8 <= end; x += 8)
+    {
+        const __m256 center = _mm256_loadu_ps(row + x);
+        const __m256 left = _mm256_loadu_ps(row + x - 1);
+        const __m256 right = _mm256_loadu_ps(row + x + 1);
+        const __m256 top = _mm256_loadu_ps(above + x);
+        const __m256 bottom = _mm256_loadu_ps(below + x);
+        const __m256 topLeft = _mm256_loadu_ps(above + x - 1);
+        const __m256 topRight = _mm256_loadu_ps(above + x + 1);
+        const __m256 bottomLeft = _mm256_loadu_ps(below + x - 1);
+        const __m256 bottomRight = _mm256_loadu_ps(below + x + 1);
+
+        const __m256 fxx = _mm256_fnmadd_ps(two, center, _mm256_add_ps(left, right));
+        const __m256 fyy = _mm256_fnmadd_ps(two, center, _mm256_add_ps(top, bottom));
+        const __m256 fxy = _mm256_mul_ps(quarter,
+            _mm256_add_ps(
+                _mm256_sub_ps(bottomRight, bottomLeft), _mm256_sub_ps(topLeft, topRight)));
+
+        // fxy^2 - fxx * fyy is the negative determinant of the Hessian
+        const __m256 saddle = _mm256_fmsub_ps(fxy, fxy, _mm256_mul_ps(fxx, fyy));
+        _mm256_storeu_ps(response + x, _mm256_max_ps(saddle, zero));
+    }
+    return x;
+}
+} // namespace detail
+} // namespace libba
@@ -0,0 +1,171 @@
+/*
+ * ViewSelection.cpp
+ *
+ *  Created on: 18.10.2026
+ */
+
+#include "camera_calibration/ViewSelection.h"
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <opencv2/calib3d.hpp>
+
+namespace libba
+{
+namespace
+{
+/**
+ * The image is divided into coverageGridSize x coverageGridSize cells to measure the coverage.
+ */
+constexpr int coverageGridSize = 16;
+using CoverageMask = std::bitset<coverageGridSize * coverageGridSize>;
+
+/**
+ * Weight of the pose diversity compared to the newly covered image area.
+ */
+constexpr double diversityWeight = 0.5;
+
+constexpr size_t poseFeatureSize = 7;
+using PoseFeature = std::array<double, poseFeatureSize>;
+
+CoverageMask computeCoverage(const std::vector<cv::Point2f>& points, const cv::Size2i& imageSize)
+{
+    CoverageMask mask;
+    for (const auto& point : points)
+    {
+        const int x = std::clamp(
+            int(point.x * coverageGridSize / imageSize.width), 0, coverageGridSize - 1);
+        const int y = std::clamp(
+            int(point.y * coverageGridSize / imageSize.height), 0, coverageGridSize - 1);
+        mask.set(y * coverageGridSize + x);
+    }
+    return mask;
+}
+//-------------------------------------------------------------------------------------------------
+/**
+ * Describes the pose of the pattern with the position, scale, in-plane rotation and the
+ * perspective part of the homography between the pattern plane and the image.
+ */
+PoseFeature computePoseFeature(const std::vector<cv::Point2f>& imagePoints,
+    const std::vector<cv::Point3f>& objectPoints, const cv::Size2i& imageSize)
+{
+    PoseFeature feature;
+    feature.fill(0);
+
+    std::vector<cv::Point2f> planePoints(objectPoints.size());
+    float patternWidth = 0;
+    float patternHeight = 0;
+    for (size_t i = 0; i < objectPoints.size(); ++i)
+    {
+        planePoints[i] = cv::Point2f(objectPoints[i].x, objectPoints[i].y);
+        patternWidth = std::max(patternWidth, objectPoints[i].x);
+        patternHeight = std::max(patternHeight, objectPoints[i].y);
+    }
+
+    const cv::Mat homography = cv::findHomography(planePoints, imagePoints);
+    if (homography.empty() || patternWidth <= 0 || patternHeight <= 0)
+        return feature;
+
+    const double diagonal = std::hypot(imageSize.width, imageSize.height);
+    const auto h = [&homography](int row, int col) { return homography.at<double>(row, col); };
+    const double scale = h(2, 2);
+
+    // center of the pattern in the image
+    const cv::Point2f center = std::accumulate(imagePoints.begin(), imagePoints.end(),
+                                   cv::Point2f(0, 0))
+        * (1.0 / imagePoints.size());
+    feature[0] = center.x / imageSize.width;
+    feature[1] = center.y / imageSize.height;
+
+    // size of the pattern in the image
+    const cv::Point2f xAxis(h(0, 0) / scale, h(1, 0) / scale);
+    const cv::Point2f yAxis(h(0, 1) / scale, h(1, 1) / scale);
+    const double size = std::sqrt(std::abs(xAxis.x * yAxis.y - xAxis.y * yAxis.x)
+        * patternWidth * patternHeight);
+    feature[2] = std::log(std::max(size, 1.0) / diagonal);
+
+    // in-plane rotation
+    const double angle = std::atan2(xAxis.y, xAxis.x);
+    feature[3] = std::cos(angle);
+    feature[4] = std::sin(angle);
+
+    // tilt of the pattern plane
+    feature[5] = h(2, 0) / scale * patternWidth;
+    feature[6] = h(2, 1) / scale * patternHeight;
+    return feature;
+}
+//-------------------------------------------------------------------------------------------------
+double distance(const PoseFeature& a, const PoseFeature& b)
+{
+    double sum = 0;
+    for (size_t i = 0; i < poseFeatureSize; ++i)
+        sum += (a[i] - b[i]) * (a[i] - b[i]);
+    return std::sqrt(sum);
+}
+} // namespace
+//-------------------------------------------------------------------------------------------------
+std::vector<size_t> selectViews(const std::vector<std::vector<cv::Point2f> >& imagePoints,
+    const std::vector<std::vector<cv::Point3f> >& objectPoints, const cv::Size2i& imageSize,
+    const size_t maxViews)
+{
+    const size_t numViews = imagePoints.size();
+    std::vector<size_t> selected;
+    if (numViews <= maxViews)
+    {
+        selected.resize(numViews);
+        std::iota(selected.begin(), selected.end(), 0);
+        return selected;
+    }
+
+    std::vector<CoverageMask> coverage(numViews);
+    std::vector<PoseFeature> poses(numViews);
+    cv::parallel_for_(cv::Range(0, static_cast<int>(numViews)), [&](const cv::Range& range) {
+        for (int i = range.start; i < range.end; ++i)
+        {
+            coverage[i] = computeCoverage(imagePoints[i], imageSize);
+            poses[i] = computePoseFeature(imagePoints[i], objectPoints[i], imageSize);
+        }
+    });
+
+    // distance of every view to the closest selected view, capped because views which are far
+    // away from all selected views are equally useful
+    constexpr double maxPoseDistance = 1.0;
+    std::vector<double> poseDistance(numViews, maxPoseDistance);
+    std::vector<bool> isSelected(numViews, false);
+    CoverageMask covered;
+
+    for (size_t step = 0; step < maxViews; ++step)
+    {
+        size_t bestView = numViews;
+        double bestScore = -std::numeric_limits<double>::max();
+        for (size_t i = 0; i < numViews; ++i)
+        {
+            if (isSelected[i])
+                continue;
+
+            const double newCoverage = double((coverage[i] & ~covered).count()) / covered.size();
+            const double score = newCoverage + diversityWeight * poseDistance[i];
+            if (score > bestScore)
+            {
+                bestScore = score;
+                bestView = i;
+            }
+        }
+
+        if (bestView == numViews)
+            break;
+
+        isSelected[bestView] = true;
+        covered |= coverage[bestView];
+        selected.push_back(bestView);
+        for (size_t i = 0; i < numViews; ++i)
+            poseDistance[i] = std::min(poseDistance[i], distance(poses[i], poses[bestView]));
+    }
+
+    std::sort(selected.begin(), selected.end());
+    return selected;
+}
+} // namespace libba
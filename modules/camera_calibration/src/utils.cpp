@@ -6,12 +6,42 @@
  */
 
 #include "camera_calibration/utils.h"
+#include "camera_calibration/ImageArchive.h"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <condition_variable>
+#include <deque>
+#include <fcntl.h>
 #include <filesystem>
+#include <mutex>
 #include <opencv2/opencv.hpp>
 #include <sstream>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
 
 namespace libba
 {
+namespace
+{
+bool equalsIgnoreCase(const std::string& a, const std::string& b)
+{
+    return a.size() == b.size()
+        && std::equal(a.begin(), a.end(), b.begin(), [](const char c1, const char c2) {
+               return std::tolower(static_cast<unsigned char>(c1))
+                   == std::tolower(static_cast<unsigned char>(c2));
+           });
+}
+//------------------------------------------------------------------------------------------------
+bool hasExtension(const std::filesystem::path& path, const std::vector<std::string>& extensions)
+{
+    const std::string extension = path.extension().string();
+    return std::any_of(extensions.begin(), extensions.end(),
+        [&extension](const std::string& e) { return equalsIgnoreCase(extension, e); });
+}
+} // namespace
+//------------------------------------------------------------------------------------------------
 std::vector<std::string> readFilesFromDir(
     const std::string& dirPath, const std::regex& extensionFilter)
 {
@@ -44,6 +74,170 @@ std::vector<std::string> readFilesFromDir(
     return files;
 }
 //------------------------------------------------------------------------------------------------
+size_t scanDirectory(const std::string& dirPath, const std::vector<std::string>& extensions,
+    const std::function<void(std::vector<std::string>&&)>& batchFunc,
+    const DirectoryScanOptions& options, const std::atomic<bool>* stopRequested)
+{
+    namespace fs = std::filesystem;
+
+    // directories which still have to be read, shared by all threads
+    std::deque<fs::path> pendingDirs;
+    int busyThreads = 0;
+    std::mutex dirMutex;
+    std::condition_variable dirCondition;
+
+    std::mutex batchMutex;
+    size_t numFiles = 0;
+
+    std::error_code ec;
+    if (!fs::is_directory(dirPath, ec))
+        return 0;
+    pendingDirs.emplace_back(dirPath);
+
+    const auto isStopped = [stopRequested]() { return stopRequested && *stopRequested; };
+
+    const auto passBatch = [&](std::vector<std::string>& batch) {
+        if (batch.empty())
+            return;
+
+        std::lock_guard<std::mutex> lock(batchMutex);
+        numFiles += batch.size();
+        batchFunc(std::move(batch));
+        batch.clear();
+    };
+
+    const auto scanWorker = [&]() {
+        std::vector<std::string> batch;
+        while (true)
+        {
+            fs::path dir;
+            {
+                std::unique_lock<std::mutex> lock(dirMutex);
+
+                // the scan is finished if no directory is left and no thread can add a new one
+                dirCondition.wait(lock, [&]() {
+                    return !pendingDirs.empty() || busyThreads == 0 || isStopped();
+                });
+                if (pendingDirs.empty() || isStopped())
+                    break;
+
+                dir = std::move(pendingDirs.front());
+                pendingDirs.pop_front();
+                busyThreads++;
+            }
+
+            std::vector<fs::path> subDirs;
+            std::error_code iterEc;
+            for (fs::directory_iterator it(dir, iterEc), end; !iterEc && it != end;
+                 it.increment(iterEc))
+            {
+                if (isStopped())
+                    break;
+
+                std::error_code entryEc;
+                if (it->is_directory(entryEc))
+                {
+                    // symbolic links are not followed to avoid cycles
+                    if (options.recursive && !it->is_symlink(entryEc))
+                        subDirs.push_back(it->path());
+                    continue;
+                }
+
+                if (!it->is_regular_file(entryEc) || !hasExtension(it->path(), extensions))
+                    continue;
+
+                batch.push_back(it->path().string());
+                if (batch.size() >= options.batchSize)
+                    passBatch(batch);
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(dirMutex);
+                for (auto& subDir : subDirs)
+                    pendingDirs.push_back(std::move(subDir));
+                busyThreads--;
+            }
+            dirCondition.notify_all();
+        }
+
+        passBatch(batch);
+        dirCondition.notify_all();
+    };
+
+    const int numThreads = std::max(1, options.numThreads);
+    std::vector<std::thread> threads;
+    for (int i = 1; i < numThreads; ++i)
+        threads.emplace_back(scanWorker);
+    scanWorker();
+
+    for (auto& thread : threads)
+        thread.join();
+
+    return numFiles;
+}
+//------------------------------------------------------------------------------------------------
+bool readFileInto(const std::string& filePath, std::vector<uchar>& buffer)
+{
+    std::string archivePath, memberName;
+    if (splitArchivePath(filePath, archivePath, memberName))
+    {
+        try
+        {
+            const std::shared_ptr<const ImageArchive> archive = ImageArchive::open(archivePath);
+            const ImageArchive::Member* member = archive->findMember(memberName);
+            if (member == nullptr)
+                return false;
+
+            const unsigned char* data = archive->getBytes(*member);
+            buffer.assign(data, data + member->size);
+            return true;
+        }
+        catch (const std::runtime_error&)
+        {
+            return false;
+        }
+    }
+
+    // POSIX io does not allocate a stream buffer like std::ifstream
+    const int fd = ::open(filePath.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat fileStatus;
+    if (::fstat(fd, &fileStatus) != 0)
+    {
+        ::close(fd);
+        return false;
+    }
+#ifdef POSIX_FADV_SEQUENTIAL
+    // the file is read once from the start to the end, the kernel can read ahead aggressively
+    ::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+    buffer.resize(static_cast<size_t>(fileStatus.st_size));
+    size_t bytesRead = 0;
+    while (bytesRead < buffer.size())
+    {
+        const ssize_t result = ::read(fd, buffer.data() + bytesRead, buffer.size() - bytesRead);
+        if (result < 0 && errno == EINTR)
+            continue;
+        if (result <= 0)
+            break;
+        bytesRead += static_cast<size_t>(result);
+    }
+    ::close(fd);
+
+    buffer.resize(bytesRead);
+    return bytesRead == static_cast<size_t>(fileStatus.st_size);
+}
+//------------------------------------------------------------------------------------------------
+cv::Mat readImage(const std::string& filePath, const int flags)
+{
+    if (isArchiveMemberPath(filePath))
+        return decodeArchiveMember(filePath, flags);
+    return cv::imread(filePath, flags);
+}
+//------------------------------------------------------------------------------------------------
 std::string matrixToHTML(const cv::Mat matrix, const std::string& tableStyle, const int precision)
 {
     if (matrix.empty())
@@ -8,12 +8,18 @@
 #ifndef CALIBRATIONWIDGET_H_
 #define CALIBRATIONWIDGET_H_
 
+#include "ImageModel.h"
 #include <QFuture>
+#include <QFutureWatcher>
+#include <QMutex>
 #include <QWidget>
+#include <atomic>
 #include <camera_calibration/CameraCalibration.h>
+#include <map>
+#include <string>
 
 class QMessageBox;
-class ImageModel;
+class QTimer;
 class ProgressState;
 class QGraphicsItem;
 
@@ -36,14 +42,20 @@ public slots:
     void on_pushButton_loeschen_clicked();
     void on_pushButton_hinzufuegen_clicked();
     void on_pushButton_ordnerHinzufuegen_clicked();
+    void on_pushButton_sitzungSpeichern_clicked();
+    void on_pushButton_sitzungLaden_clicked();
     void on_comboBox_ansicht_currentIndexChanged(int index);
 
     void showImage(const QModelIndex& currentIndex);
     void updateResults(bool success = true, const QString& errorMsg = "");
     void stopCalibration();
+    void calibrationFinished();
+    void flushPendingResults();
+    void scanFinished();
 
 signals:
     void calibrationDone(bool success = true, const QString& errorMsg = "");
+    void filesFound(const QStringList& filePaths);
 
 protected:
     Ui::CalibrationWidget* calibrationWidget;
@@ -56,12 +68,82 @@ protected:
 
     libba::CameraCalibration calibTool;
     QFuture<void> calibrationFuture;
+    QFutureWatcher<void> calibrationWatcher;
 
     bool calibrationRunning;
 
+    /**
+     * Set by the calibration thread if the last calibration finished successfully.
+     */
+    bool calibrationSucceeded;
+
+    /**
+     * Periodically moves the detection results reported by the calibration thread into the
+     * image model, so that the model is updated in batches at a fixed rate.
+     */
+    QTimer* resultUpdateTimer;
+
+    /**
+     * Detection results which were reported by the calibration thread but are not yet shown in
+     * the image model. The key is the row of the image in the model.
+     */
+    std::map<int, libba::CameraCalibration::CalibImgInfo> pendingResults;
+    QMutex pendingResultsMutex;
+
+    /**
+     * Search for images in a directory which runs in the background.
+     */
+    QFuture<QStringList> scanFuture;
+    QFutureWatcher<QStringList> scanWatcher;
+    std::atomic<bool> scanStopRequested;
+    QString folderButtonText;
+
     void startCalibration();
+
+    /**
+     * Stops the calibration and blocks until the calibration thread has finished.
+     */
+    void waitForCalibration();
+
+    /**
+     * Lists the images of the last calibration whose pattern detection exceeded the time budget.
+     */
+    void showTimedOutImages();
     void doCalibration(const QString& filePath, const std::vector<int>& filePathModelIndices);
 
+    /**
+     * Searches the images in a directory and returns the errors of the archives which could not
+     * be read.
+     */
+    QStringList doScanDirectory(const QString& dirPath);
+
+    /**
+     * Returns the text which is shown in the image table for a skipped pattern detection.
+     */
+    QString skipReasonText(const libba::CameraCalibration::SkipReason reason) const;
+
+    /**
+     * Returns the text which is shown in the image table for the way the pattern was found.
+     */
+    QString detectionMethodText(const libba::CameraCalibration::CalibImgInfo& info) const;
+
+    /**
+     * Copies the detection results of an image into the data of its row in the image model.
+     */
+    void setDetectionResult(
+        const libba::CameraCalibration::CalibImgInfo& info, ImageModel::ImgData& data) const;
+
+    /**
+     * Returns the contents of all input fields, combo boxes and check boxes by their object
+     * names, so that they can be stored in a session.
+     */
+    std::map<std::string, std::string> getSettings() const;
+
+    /**
+     * Restores the inputs from getSettings(). Unknown names are ignored.
+     */
+    void applySettings(const std::map<std::string, std::string>& settings);
+
     void connectSignalsAndSlots();
 
     void setupUi();
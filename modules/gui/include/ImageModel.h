@@ -28,10 +28,18 @@ public:
     {
         bool checked = false;
         bool found = false;
+        bool used = false;
         std::string filePath;
         float error = 0.f;
         int row = -1;
         std::vector<cv::Point2f> boardCornersImg;
+        std::vector<int> pointIds;
+        int cornerCount = 0;
+        float detectionTime = 0.f;
+        float sharpness = 0.f;
+        float clippedRatio = 0.f;
+        QString method;
+        QString note;
     };
 
     ImageModel(QObject* parent = 0);
@@ -39,6 +47,11 @@ public:
 
     void addImage(QString imgPath);
 
+    /**
+     * Adds images with their detection results, e.g. from a session. All rows are added at once.
+     */
+    void addImages(const std::vector<ImgData>& images);
+
     ImgData getImageData(int idx);
     std::vector<ImgData> getImageData();
     void setImageData(int idx, ImgData data);
@@ -52,6 +65,7 @@ protected:
     std::vector<ImgData> imageData;
 
 public slots:
+    void addImages(const QStringList& imgPaths);
     void rowsRemoved(const QModelIndex& parent, int start, int end);
     void changeItem(QStandardItem* item);
 };
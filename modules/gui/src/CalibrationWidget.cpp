@@ -10,23 +10,54 @@
 #include "qtOpenCVConversions.h"
 #include "ui_CalibrationWidget.h"
 #include <ProgressState.h>
+#include <QCheckBox>
+#include <QComboBox>
 #include <QFileDialog>
 #include <QGraphicsPixmapItem>
+#include <QLineEdit>
 #include <QMessageBox>
+#include <QTimer>
 #include <QWidget>
 #include <QtConcurrent>
 #include <QtCore>
+#include <QStandardItemModel>
+#include <camera_calibration/CalibrationPattern.h>
+#include <camera_calibration/CalibrationSession.h>
+#include <camera_calibration/ImageArchive.h>
 #include <camera_calibration/utils.h>
+#include <algorithm>
 #include <functional>
 #include <regex>
+#include <unordered_map>
 #include <vector>
 
+namespace
+{
+/**
+ * Interval in milliseconds in which detection results are moved into the image model.
+ */
+constexpr int resultUpdateInterval = 200;
+
+/**
+ * Number of threads which search directories for images. Several threads help on network file
+ * systems where listing a directory is slow.
+ */
+constexpr int scanThreads = 4;
+
+/**
+ * Extensions of the images which are added from directories and archives.
+ */
+const std::vector<std::string> imageExtensions = { ".png", ".jpg", ".jpeg" };
+} // namespace
+
 CalibrationWidget::CalibrationWidget(QWidget* parent)
     : QWidget(parent)
     , calibrationWidget(new Ui::CalibrationWidget)
     , imgModel(new ImageModel)
     , currentImage(0)
     , calibrationRunning(false)
+    , calibrationSucceeded(false)
+    , scanStopRequested(false)
 {
     setupUi();
     connectSignalsAndSlots();
@@ -34,8 +65,13 @@ CalibrationWidget::CalibrationWidget(QWidget* parent)
 //------------------------------------------------------------------------------------------------
 CalibrationWidget::~CalibrationWidget()
 {
+    // the calibration and the search thread use this object, therefore they have to be finished
+    // first
     if (calibrationRunning)
-        stopCalibration();
+        waitForCalibration();
+
+    scanStopRequested = true;
+    scanFuture.waitForFinished();
 }
 //------------------------------------------------------------------------------------------------
 void CalibrationWidget::on_pushButton_kalibrieren_clicked()
@@ -95,6 +131,80 @@ void CalibrationWidget::startCalibration()
         return;
     }
 
+    std::shared_ptr<const libba::CalibrationPattern> pattern;
+    const cv::Size2i patternSize(cornersHorizontal, cornersVertical);
+    try
+    {
+        switch (calibrationWidget->comboBox_pattern->currentIndex())
+        {
+        case 1:
+            pattern = std::make_shared<libba::CircleGridPattern>(patternSize, squareWidth, false);
+            break;
+        case 2:
+            pattern = std::make_shared<libba::CircleGridPattern>(patternSize, squareWidth, true);
+            break;
+        case 3:
+        {
+            const double markerWidth
+                = calibrationWidget->lineEdit_markerSize->text().toDouble(&ok);
+            if (!ok)
+            {
+                showError(tr("Bitte das Eingabefeld für die Markergröße überprüfen."));
+                return;
+            }
+            pattern = std::make_shared<libba::CharucoPattern>(
+                patternSize, squareWidth, markerWidth);
+            break;
+        }
+        default:
+            pattern = std::make_shared<libba::ChessboardPattern>(patternSize, squareWidth);
+        }
+    }
+    catch (const std::exception& e)
+    {
+        showError(tr("Das Kalibriermuster ist ungültig: ") + QString::fromStdString(e.what()));
+        return;
+    }
+
+    const int maxViews = calibrationWidget->lineEdit_maxViews->text().toInt(&ok);
+    if (!ok || maxViews < 0)
+    {
+        showError(tr("Bitte das Eingabefeld für die maximale Anzahl an Ansichten überprüfen. Es "
+                     "muss eine positive ganze Zahl oder 0 eingegeben werden."));
+        return;
+    }
+
+    const int duplicateThreshold
+        = calibrationWidget->lineEdit_duplicateThreshold->text().toInt(&ok);
+    if (!ok)
+    {
+        showError(tr("Bitte das Eingabefeld für die maximale Hash-Distanz von Duplikaten "
+                     "überprüfen. Es muss eine ganze Zahl eingegeben werden."));
+        return;
+    }
+
+    const double minSharpness = calibrationWidget->lineEdit_minSharpness->text().toDouble(&ok);
+    if (!ok)
+    {
+        showError(tr("Bitte das Eingabefeld für die minimale Schärfe überprüfen."));
+        return;
+    }
+
+    const double maxClipped = calibrationWidget->lineEdit_maxClipped->text().toDouble(&ok);
+    if (!ok || maxClipped < 0 || maxClipped > 100)
+    {
+        showError(tr("Bitte das Eingabefeld für den maximalen Anteil fehlbelichteter Pixel "
+                     "überprüfen. Es muss eine Zahl zwischen 0 und 100 eingegeben werden."));
+        return;
+    }
+
+    const double timeBudget = calibrationWidget->lineEdit_timeBudget->text().toDouble(&ok);
+    if (!ok || timeBudget < 0)
+    {
+        showError(tr("Bitte das Eingabefeld für das Zeitbudget pro Bild überprüfen."));
+        return;
+    }
+
     std::vector<ImageModel::ImgData> imageData = imgModel->getImageData();
     if (imageData.size() <= 0)
     {
@@ -107,8 +217,16 @@ void CalibrationWidget::startCalibration()
     for (size_t i = 0; i < imageData.size(); ++i)
     {
         imageData[i].found = false;
+        imageData[i].used = false;
         imageData[i].error = 0;
         imageData[i].boardCornersImg.clear();
+        imageData[i].pointIds.clear();
+        imageData[i].cornerCount = 0;
+        imageData[i].detectionTime = 0;
+        imageData[i].sharpness = 0;
+        imageData[i].clippedRatio = 0;
+        imageData[i].method.clear();
+        imageData[i].note.clear();
 
         imgModel->setImageData(i, imageData[i]);
 
@@ -121,11 +239,13 @@ void CalibrationWidget::startCalibration()
 
     // Get filepath
     const QString filePath = QFileDialog::getSaveFileName(this, tr("Datei speichern"),
-        QDir::homePath() + "/", tr("XML-Dateien (*.xml);;JSON-Dateien (*.json)"));
+        QDir::homePath() + "/",
+        tr("XML-Dateien (*.xml);;JSON-Dateien (*.json);;JSON mit Ansichten (*.views.json);;"
+           "Binärdateien (*.bcal)"));
 
-    if (!filePath.endsWith(".xml") && !filePath.endsWith(".json"))
+    if (!filePath.endsWith(".xml") && !filePath.endsWith(".json") && !filePath.endsWith(".bcal"))
     {
-        showError(tr("Die Datei muss die Endung \".xml\" oder \".json\" haben."));
+        showError(tr("Die Datei muss die Endung \".xml\", \".json\" oder \".bcal\" haben."));
         return;
     }
 
@@ -136,10 +256,31 @@ void CalibrationWidget::startCalibration()
     }
 
     // set parameters
-    calibTool.setChessboardSize(cv::Size2i(cornersHorizontal, cornersVertical));
-    calibTool.setChessboardSquareWidth(squareWidth);
+    calibTool.setPattern(pattern);
     calibTool.setCornerRefinmentWindowSize(
         cv::Size2i(cornerRefinmentWindowSizeHorizontal, cornerRefinmentWindowSizeVertical));
+    calibTool.setMaxCalibrationViews(maxViews);
+    calibTool.setDuplicateThreshold(duplicateThreshold);
+    calibTool.setQualityThresholds(minSharpness, maxClipped / 100.0);
+
+    // the image list shows the quality scores of all images
+    calibTool.setComputeQualityScores(true);
+    calibTool.setDetectionTimeBudget(
+        timeBudget, calibrationWidget->checkBox_retryDownscaled->isChecked());
+
+    using Strategy = libba::CameraCalibration::DetectionStrategy;
+    if (calibrationWidget->checkBox_detectionLadder->isChecked())
+        calibTool.setDetectionLadder({ Strategy::DownscaledFastCheck, Strategy::Default,
+                                         Strategy::AdaptiveNormalize, Strategy::SectorBased },
+            calibrationWidget->checkBox_adaptiveLadder->isChecked());
+    else
+        calibTool.setDetectionLadder({ Strategy::Default });
+
+    using Backend = libba::CameraCalibration::DetectionBackend;
+    const std::vector<Backend> backends = { Backend::ClassicCornerSubPix, Backend::ClassicFind4Quad,
+        Backend::SectorBased, Backend::SectorBasedAccuracy, Backend::SaddlePoint };
+    calibTool.setDetectionBackend(
+        backends.at(calibrationWidget->comboBox_detectionBackend->currentIndex()));
 
     int calibrationFlags = 0;
     switch (calibrationWidget->comboBox_distortionModel->currentIndex())
@@ -172,14 +313,31 @@ void CalibrationWidget::startCalibration()
 
     calibTool.setCalibrationFlags(calibrationFlags);
 
+    // without the steps the stop button has to wait for the whole run of the solver
+    calibTool.setInterruptibleSolver(
+        calibrationWidget->checkBox_interruptibleSolver->isChecked());
+
+    // the detection results are journaled next to the result file, so that an interrupted
+    // calibration does not have to detect the patterns of the finished images again
+    calibTool.setJournal(filePath.toStdString() + ".journal",
+        calibrationWidget->checkBox_resumeJournal->isChecked());
+
     calibrationWidget->pushButton_kalibrieren->setText(tr("Kalibrierung stoppen"));
     calibrationWidget->tableView_images->setEditTriggers(QAbstractItemView::NoEditTriggers);
     imgModel->setCheckboxesEnabled(false);
     disableButtons();
 
+    {
+        QMutexLocker locker(&pendingResultsMutex);
+        pendingResults.clear();
+    }
+    resultUpdateTimer->start(resultUpdateInterval);
+    calibrationSucceeded = false;
+
     // http://qt-project.org/wiki/QtConcurrent-run-member-function
     calibrationFuture = QtConcurrent::run(
         this, &CalibrationWidget::doCalibration, filePath, filePathModelIndices);
+    calibrationWatcher.setFuture(calibrationFuture);
     calibrationRunning = true;
 }
 //------------------------------------------------------------------------------------------------
@@ -188,9 +346,18 @@ void CalibrationWidget::doCalibration(
 {
     namespace pl = std::placeholders;
     auto f = std::bind(&ProgressState::emitSignals, calibrationState, pl::_1, pl::_2, pl::_3);
+
+    // the image model must only be changed by the gui thread, therefore the results are collected
+    // here and moved into the model by flushPendingResults()
+    auto imageResultFunc = [this, &filePathModelIndices](
+                               size_t idx, const libba::CameraCalibration::CalibImgInfo& info) {
+        QMutexLocker locker(&pendingResultsMutex);
+        pendingResults[filePathModelIndices[idx]] = info;
+    };
+
     try
     {
-        calibTool.calibrateCamera(f);
+        calibTool.calibrateCamera(f, imageResultFunc);
     }
     catch (const std::runtime_error& e)
     {
@@ -212,19 +379,9 @@ void CalibrationWidget::doCalibration(
         return;
 
     calibTool.saveCameraParameters(filePath.toStdString());
-    const std::vector<libba::CameraCalibration::CalibImgInfo> imgs = calibTool.getCalibInfo();
-
-    // update the imagemodel
-    for (size_t i = 0; i < imgs.size(); ++i)
-    {
-        int modelIdx = filePathModelIndices[i];
-        ImageModel::ImgData data = imgModel->getImageData(modelIdx);
-        data.found = imgs[i].patternFound;
-        data.error = imgs[i].reprojectionError;
-        data.boardCornersImg = imgs[i].boardCornersImg;
 
-        imgModel->setImageData(modelIdx, data);
-    }
+    // read by calibrationFinished() after the thread has finished
+    calibrationSucceeded = true;
 
     // signals must be used here because otherwise calibrationDone() and the gui would run in
     // different threads
@@ -233,27 +390,133 @@ void CalibrationWidget::doCalibration(
 //------------------------------------------------------------------------------------------------
 void CalibrationWidget::stopCalibration()
 {
+    if (!calibrationRunning)
+        return;
+
+    // only request the stop, calibrationFinished() is called as soon as the thread has finished
     calibTool.stopCalibration();
+    calibrationWidget->pushButton_kalibrieren->setText(tr("Kalibrierung wird gestoppt..."));
+    calibrationWidget->pushButton_kalibrieren->setDisabled(true);
+}
+//------------------------------------------------------------------------------------------------
+void CalibrationWidget::calibrationFinished()
+{
+    resultUpdateTimer->stop();
 
-    // cancel the calibration and wait for thread has finished
-    if (calibrationFuture.isRunning())
-    {
-        QMessageBox::information(this, tr("Kalibrierung stoppen"),
-            tr("Die Kalibrierung wird abgebrochen, dies kann einen Moment dauern."));
-        calibrationFuture.cancel();
-        calibrationFuture.waitForFinished();
-    }
-    else
-        QMessageBox::information(this, tr("Kalibrierung abgeschlossen"),
-            tr("Das Kalibrieren der Kamera ist abegschlossen."));
+    // show the results which were reported until the calibration has finished
+    flushPendingResults();
 
     calibrationRunning = false;
     imgModel->setCheckboxesEnabled(true);
     calibrationWidget->pushButton_kalibrieren->setText(tr("Kalibrieren"));
+    calibrationWidget->pushButton_kalibrieren->setDisabled(false);
 
     // reset progressbar
     calibrationWidget->progressBar->setValue(0);
     enableButtons();
+
+    if (!calibTool.isStopRequested() && calibrationSucceeded)
+    {
+        QMessageBox::information(this, tr("Kalibrierung abgeschlossen"),
+            tr("Das Kalibrieren der Kamera ist abegschlossen."));
+        showTimedOutImages();
+    }
+}
+//------------------------------------------------------------------------------------------------
+void CalibrationWidget::showTimedOutImages()
+{
+    QStringList timedOutImages;
+    for (const auto& info : calibTool.getCalibInfo())
+        if (info.detectionTimedOut)
+            timedOutImages << QString::fromStdString(info.filePath);
+
+    if (timedOutImages.isEmpty())
+        return;
+
+    QMessageBox msgBox(QMessageBox::Information, tr("Zeitüberschreitung"),
+        tr("Bei %1 Bild(ern) hat die Mustererkennung das Zeitbudget überschritten.")
+            .arg(timedOutImages.size()),
+        QMessageBox::Ok, this);
+    msgBox.setDetailedText(timedOutImages.join("\n"));
+    msgBox.exec();
+}
+//------------------------------------------------------------------------------------------------
+void CalibrationWidget::waitForCalibration()
+{
+    calibTool.stopCalibration();
+    calibrationFuture.waitForFinished();
+}
+//------------------------------------------------------------------------------------------------
+void CalibrationWidget::flushPendingResults()
+{
+    std::map<int, libba::CameraCalibration::CalibImgInfo> results;
+    {
+        QMutexLocker locker(&pendingResultsMutex);
+        results.swap(pendingResults);
+    }
+
+    for (const auto& [modelIdx, info] : results)
+    {
+        ImageModel::ImgData data = imgModel->getImageData(modelIdx);
+        setDetectionResult(info, data);
+        imgModel->setImageData(modelIdx, data);
+    }
+}
+//------------------------------------------------------------------------------------------------
+void CalibrationWidget::setDetectionResult(
+    const libba::CameraCalibration::CalibImgInfo& info, ImageModel::ImgData& data) const
+{
+    data.found = info.patternFound;
+    data.used = info.usedForCalibration;
+    data.error = info.reprojectionError;
+    data.boardCornersImg = info.boardCornersImg;
+    data.pointIds = info.pointIds;
+    data.cornerCount = static_cast<int>(info.boardCornersImg.size());
+    data.detectionTime = info.detectionTime;
+    data.sharpness = info.sharpness;
+    data.clippedRatio = info.clippedRatio;
+    data.method = info.patternFound ? detectionMethodText(info) : "";
+    data.note = skipReasonText(info.skipReason);
+}
+//------------------------------------------------------------------------------------------------
+QString CalibrationWidget::skipReasonText(const libba::CameraCalibration::SkipReason reason) const
+{
+    switch (reason)
+    {
+    case libba::CameraCalibration::SkipReason::NearDuplicate:
+        return tr("Duplikat");
+    case libba::CameraCalibration::SkipReason::Blurred:
+        return tr("Unscharf");
+    case libba::CameraCalibration::SkipReason::BadExposure:
+        return tr("Fehlbelichtet");
+    case libba::CameraCalibration::SkipReason::TimedOut:
+        return tr("Zeitüberschreitung");
+    default:
+        return "";
+    }
+}
+//------------------------------------------------------------------------------------------------
+QString CalibrationWidget::detectionMethodText(
+    const libba::CameraCalibration::CalibImgInfo& info) const
+{
+    if (info.cornersTracked)
+        return tr("Verfolgt");
+
+    switch (info.detectionStrategy)
+    {
+    case libba::CameraCalibration::DetectionStrategy::DownscaledFastCheck:
+        return tr("Verkleinert");
+    case libba::CameraCalibration::DetectionStrategy::AdaptiveNormalize:
+        return tr("Normalisiert");
+    case libba::CameraCalibration::DetectionStrategy::SectorBased:
+        return tr("SB");
+    case libba::CameraCalibration::DetectionStrategy::SectorBasedAccuracy:
+        return tr("SB (genau)");
+    case libba::CameraCalibration::DetectionStrategy::SaddlePoint:
+        return tr("Sattelpunkte");
+    default:
+        return tr("Standard");
+    }
 }
 //------------------------------------------------------------------------------------------------
 void CalibrationWidget::on_pushButton_loeschen_clicked()
@@ -264,24 +527,118 @@ void CalibrationWidget::on_pushButton_loeschen_clicked()
 //------------------------------------------------------------------------------------------------
 void CalibrationWidget::on_pushButton_hinzufuegen_clicked()
 {
-    const QString filePath = QFileDialog::getOpenFileName(
-        this, tr("Datei öffnen"), QDir::homePath(), tr("Images (*.png *.jpg)"));
+    const QString filePath = QFileDialog::getOpenFileName(this, tr("Datei öffnen"),
+        QDir::homePath(), tr("Images (*.png *.jpg);;Archive (*.tar *.zip)"));
 
     if (filePath == "")
         return;
 
-    imgModel->addImage(filePath);
+    if (!libba::ImageArchive::isArchive(filePath.toStdString()))
+    {
+        imgModel->addImage(filePath);
+        return;
+    }
+
+    // all images of an archive are added
+    try
+    {
+        const auto archive = libba::ImageArchive::open(filePath.toStdString());
+        QStringList filePaths;
+        for (const auto& memberPath : archive->getMemberPaths(imageExtensions))
+            filePaths.append(QString::fromStdString(memberPath));
+        imgModel->addImages(filePaths);
+    }
+    catch (const std::runtime_error& e)
+    {
+        showError(tr("Das Archiv konnte nicht gelesen werden: ") + QString(e.what()));
+    }
 }
 //------------------------------------------------------------------------------------------------
 void CalibrationWidget::on_pushButton_ordnerHinzufuegen_clicked()
 {
+    // a search is already running --> stop it
+    if (scanFuture.isRunning())
+    {
+        scanStopRequested = true;
+        return;
+    }
+
     const QString dirPath = QFileDialog::getExistingDirectory(
         this, tr("Ordner öffnen"), QDir::homePath(), QFileDialog::ShowDirsOnly);
-    const std::regex filter(".*\\.JPG|.*\\.PNG|.*\\.jpg||.*\\.png", std::regex::icase);
-    std::vector<std::string> files = libba::readFilesFromDir(dirPath.toStdString(), filter);
+    if (dirPath.isEmpty())
+        return;
+
+    folderButtonText = calibrationWidget->pushButton_ordnerHinzufuegen->text();
+    calibrationWidget->pushButton_ordnerHinzufuegen->setText(tr("Suche abbrechen"));
+    calibrationWidget->pushButton_kalibrieren->setDisabled(true);
 
-    for (const auto& file : files)
-        imgModel->addImage(QString::fromStdString(file));
+    scanStopRequested = false;
+    scanFuture = QtConcurrent::run(this, &CalibrationWidget::doScanDirectory, dirPath);
+    scanWatcher.setFuture(scanFuture);
+}
+//------------------------------------------------------------------------------------------------
+QStringList CalibrationWidget::doScanDirectory(const QString& dirPath)
+{
+    std::vector<std::string> extensions = imageExtensions;
+    extensions.insert(extensions.end(), { ".tar", ".zip" });
+
+    libba::DirectoryScanOptions options;
+    options.numThreads = scanThreads;
+
+    // the found files are added by the gui thread, the signal is delivered as queued connection
+    QStringList brokenArchives;
+    auto batchFunc = [this, &brokenArchives](std::vector<std::string>&& files) {
+        std::sort(files.begin(), files.end());
+
+        QStringList filePaths;
+        filePaths.reserve(static_cast<int>(files.size()));
+        for (const auto& file : files)
+        {
+            if (!libba::ImageArchive::isArchive(file))
+            {
+                filePaths.append(QString::fromStdString(file));
+                continue;
+            }
+
+            // the images of archives are added with their virtual paths, broken archives are
+            // reported after the search
+            try
+            {
+                const auto archive = libba::ImageArchive::open(file);
+                for (const auto& memberPath : archive->getMemberPaths(imageExtensions))
+                    filePaths.append(QString::fromStdString(memberPath));
+            }
+            catch (const std::runtime_error& e)
+            {
+                brokenArchives << QString(e.what());
+            }
+        }
+
+        emit filesFound(filePaths);
+    };
+
+    libba::scanDirectory(
+        dirPath.toStdString(), extensions, batchFunc, options, &scanStopRequested);
+
+    // the archives are opened again by the calibration
+    libba::ImageArchive::closeCachedArchives();
+    return brokenArchives;
+}
+//------------------------------------------------------------------------------------------------
+void CalibrationWidget::scanFinished()
+{
+    calibrationWidget->pushButton_ordnerHinzufuegen->setText(folderButtonText);
+    calibrationWidget->pushButton_kalibrieren->setDisabled(false);
+
+    const QStringList brokenArchives = scanFuture.result();
+    if (brokenArchives.isEmpty())
+        return;
+
+    QMessageBox msgBox(QMessageBox::Warning, tr("Fehlerhafte Archive"),
+        tr("%1 Archiv(e) konnten nicht gelesen werden.").arg(brokenArchives.size()),
+        QMessageBox::Ok, this);
+    msgBox.setDetailedText(brokenArchives.join("\n"));
+    msgBox.exec();
 }
 //------------------------------------------------------------------------------------------------
 void CalibrationWidget::setupUi()
@@ -296,8 +653,19 @@ void CalibrationWidget::setupUi()
     calibrationWidget->lineEdit_cornerRefinmentWindowSizeVertical->setValidator(qiv2);
     calibrationWidget->lineEdit_cornerRefinmentWindowSizeHorizontal->setValidator(qiv2);
 
+    QIntValidator* qiv3 = new QIntValidator(0, std::numeric_limits<int>::max(), this);
+    calibrationWidget->lineEdit_maxViews->setValidator(qiv3);
+
+    QIntValidator* qiv4 = new QIntValidator(-1, 64, this);
+    calibrationWidget->lineEdit_duplicateThreshold->setValidator(qiv4);
+
     QDoubleValidator* qdv = new QDoubleValidator(0, std::numeric_limits<double>::max(), 10, this);
     calibrationWidget->lineEdit_quadratGroesse->setValidator(qdv);
+    calibrationWidget->lineEdit_minSharpness->setValidator(qdv);
+    calibrationWidget->lineEdit_timeBudget->setValidator(qdv);
+
+    QDoubleValidator* qdv2 = new QDoubleValidator(0, 100, 2, this);
+    calibrationWidget->lineEdit_maxClipped->setValidator(qdv2);
 
     errorDialog
         = new QMessageBox(QMessageBox::Warning, tr("Fehler"), tr("Fehler"), QMessageBox::Ok, this);
@@ -319,7 +687,15 @@ void CalibrationWidget::setupUi()
     calibrationWidget->lineEdit_quadratGroesse->setText(
         QString::number(calibTool.getChessboardSquareWidth()));
 
+    // the ChArUco board can only be selected if OpenCV has the ArUco module
+    if (!libba::CharucoPattern::isSupported())
+        qobject_cast<QStandardItemModel*>(calibrationWidget->comboBox_pattern->model())
+            ->item(3)
+            ->setEnabled(false);
+
     calibrationState = new ProgressState(calibrationWidget->progressBar);
+
+    resultUpdateTimer = new QTimer(this);
 }
 //------------------------------------------------------------------------------------------------
 void CalibrationWidget::showImage(const QModelIndex& currentIndex)
@@ -335,11 +711,13 @@ void CalibrationWidget::showImage(const QModelIndex& currentIndex)
 
     const auto filePath = QString::fromStdString(imgModel->getImageData(row).filePath);
 
-
-    if (!QFile::exists(filePath))
+    // the path can also point into an archive
+    cv::Mat cvImg = libba::readImage(filePath.toStdString(), cv::IMREAD_COLOR);
+    if (cvImg.empty())
     {
         errorDialog->setText(
-            tr("Das Angeforderte Bild existiert nicht mehr im Dateisystem: ") + filePath);
+            tr("Das Angeforderte Bild existiert nicht mehr oder konnte nicht geöffnet werden: ")
+            + filePath);
         errorDialog->show();
         return;
     }
@@ -348,36 +726,30 @@ void CalibrationWidget::showImage(const QModelIndex& currentIndex)
     {
     case 0:
     {
-        QImage img(filePath);
-
-        if (img.isNull())
-        {
-            showError(tr("Das Bild konnte nicht geöffnet werden."));
-            return;
-        }
-
-        currentImage = new QGraphicsPixmapItem(QPixmap::fromImage(img));
+        currentImage = new QGraphicsPixmapItem(qtOpenCvConversions::cvMatToQPixmap(cvImg));
         break;
     }
     case 1:
     {
-        if (!calibTool.isCalibrationDataAvailable())
+        // the result stays valid even if a calibration running in the background finishes
+        const libba::CameraCalibration::CalibrationResultPtr result = calibTool.getResult();
+        if (!result)
         {
             showError(tr(
                 "Für diese Funktion müssen erst Kameraparameter berechnet oder geladen werden."));
             return;
         }
 
-        cv::Mat cvImg = cv::imread(filePath.toStdString(), cv::IMREAD_COLOR);
         cv::Mat imgUndist;
-        cv::undistort(cvImg, imgUndist, calibTool.getCameraMatrix(), calibTool.getDistCoeffs());
+        cv::undistort(cvImg, imgUndist, result->cameraMatrix, result->distCoeffs);
 
         currentImage = new QGraphicsPixmapItem(qtOpenCvConversions::cvMatToQPixmap(imgUndist));
         break;
     }
     case 2:
     {
-        if (!calibTool.isCalibrationDataAvailable())
+        const libba::CameraCalibration::CalibrationResultPtr result = calibTool.getResult();
+        if (!result)
         {
             showError(tr("Für diese Funktion müssen erst Kameraparameter geladen werden."));
             return;
@@ -389,9 +761,8 @@ void CalibrationWidget::showImage(const QModelIndex& currentIndex)
                 currentImage = new QGraphicsPixmapItem(0);
             else
             {
-                cv::Mat cvImg = cv::imread(filePath.toStdString(), cv::IMREAD_COLOR);
-                cv::drawChessboardCorners(cvImg, calibTool.getChessboardSize(),
-                    imgModel->getImageData(currentIndex.row()).boardCornersImg, true);
+                const ImageModel::ImgData data = imgModel->getImageData(currentIndex.row());
+                result->pattern->drawObservation(cvImg, data.boardCornersImg, data.pointIds);
                 currentImage = new QGraphicsPixmapItem(qtOpenCvConversions::cvMatToQPixmap(cvImg));
             }
         }
@@ -419,15 +790,19 @@ void CalibrationWidget::updateResults(bool success, const QString& errorMsg)
         return;
     }
 
+    const libba::CameraCalibration::CalibrationResultPtr result = calibTool.getResult();
+    if (!result)
+        return;
+
     constexpr int precision = 5;
     const std::string tableStyle = "cellpadding=\"2\"";
-    std::string tableHTML = libba::matrixToHTML(calibTool.getCameraMatrix(), tableStyle, precision);
+    std::string tableHTML = libba::matrixToHTML(result->cameraMatrix, tableStyle, precision);
 
     calibrationWidget->label_cameraMatrix->setText(QString::fromStdString(tableHTML));
 
 
     tableHTML = "<table cellpadding=\"2\">";
-    for (size_t i = 0; i < calibTool.getNumDistortionCoefficents(); ++i)
+    for (size_t i = 0; i < result->numDistortionCoefficents; ++i)
     {
         std::string label = "";
         switch (i)
@@ -495,39 +870,157 @@ void CalibrationWidget::updateResults(bool success, const QString& errorMsg)
         }
         label += ":";
         tableHTML += "<tr><td>" + label + "</td><td>"
-            + std::to_string(calibTool.getDistCoeffs().at<double>(i)) + "</td></tr>";
+            + std::to_string(result->distCoeffs.at<double>(i)) + "</td></tr>";
     }
 
     tableHTML += "</table>";
     calibrationWidget->label_distoritionCoefficents->setText(QString::fromStdString(tableHTML));
     calibrationWidget->label_reprojectionError->setText(
-        QString::number(calibTool.getReprojectionError(), 'g', 4));
+        QString::number(result->reprojectionError, 'g', 4));
 }
 //------------------------------------------------------------------------------------------------
 void CalibrationWidget::on_pushButton_kalibrierdatenLaden_clicked()
 {
-    QString filePath = QFileDialog::getOpenFileName(
-        this, tr("Datei öffnen"), QDir::homePath(), tr("XML (*.xml);;JSON (*.json)"));
+    QString filePath = QFileDialog::getOpenFileName(this, tr("Datei öffnen"), QDir::homePath(),
+        tr("XML (*.xml);;JSON (*.json);;BCAL (*.bcal)"));
 
     if (filePath == "")
         return;
 
     std::smatch match_result;
-    std::regex pattern("\\.(json|xml)?$");
+    std::regex pattern("\\.(json|xml|bcal)?$");
     const std::string tmpStr = filePath.toStdString();
     if (!std::regex_search(tmpStr, match_result, pattern))
         throw std::runtime_error("Path does not match the pattern.");
 
-    if (match_result[0] == ".json")
-        calibTool.loadCameraParametersJSON(filePath.toStdString());
-    else if (match_result[0] == ".xml")
-        calibTool.loadCameraParametersXML(filePath.toStdString());
-    else
+    // the parser of json files throws std::logic_error and OpenCV throws cv::Exception
+    try
+    {
+        if (match_result[0] == ".json")
+            calibTool.loadCameraParametersJSON(filePath.toStdString());
+        else if (match_result[0] == ".xml")
+            calibTool.loadCameraParametersXML(filePath.toStdString());
+        else if (match_result[0] == ".bcal")
+            calibTool.loadCameraParametersBinary(filePath.toStdString());
+        else
+            return;
+    }
+    catch (const std::exception& e)
+    {
+        showError(tr("Die Kalibrierdaten konnten nicht geladen werden: ") + QString(e.what()));
         return;
+    }
 
     updateResults();
 }
 //------------------------------------------------------------------------------------------------
+void CalibrationWidget::on_pushButton_sitzungSpeichern_clicked()
+{
+    const QString filePath = QFileDialog::getSaveFileName(this, tr("Sitzung speichern"),
+        QDir::homePath() + "/", tr("Sitzungen (*.calibsession)"));
+    if (filePath.isEmpty())
+        return;
+
+    libba::CalibrationSession session;
+    for (const ImageModel::ImgData& data : imgModel->getImageData())
+        session.images.push_back({ data.filePath, data.checked });
+    session.settings = getSettings();
+
+    try
+    {
+        libba::saveSession(filePath.toStdString(), session, calibTool);
+    }
+    catch (const std::runtime_error& e)
+    {
+        showError(tr("Die Sitzung konnte nicht gespeichert werden: ") + QString(e.what()));
+    }
+}
+//------------------------------------------------------------------------------------------------
+void CalibrationWidget::on_pushButton_sitzungLaden_clicked()
+{
+    // images which are found later by a running search would be added to the loaded session
+    if (scanFuture.isRunning())
+    {
+        showError(tr("Bitte zuerst die Suche nach Bildern abbrechen."));
+        return;
+    }
+
+    const QString filePath = QFileDialog::getOpenFileName(
+        this, tr("Sitzung öffnen"), QDir::homePath(), tr("Sitzungen (*.calibsession)"));
+    if (filePath.isEmpty())
+        return;
+
+    // only the session and the mapped result are read, the images are decoded when they are shown
+    libba::CalibrationSession session;
+    try
+    {
+        session = libba::loadSession(filePath.toStdString(), calibTool);
+    }
+    catch (const std::runtime_error& e)
+    {
+        showError(tr("Die Sitzung konnte nicht geladen werden: ") + QString(e.what()));
+        return;
+    }
+
+    applySettings(session.settings);
+
+    // the detections of the images are taken from the views of the result by their file paths
+    const libba::CameraCalibration::CalibrationResultPtr result = calibTool.getResult();
+    std::unordered_map<std::string, const libba::CameraCalibration::CalibImgInfo*> views;
+    if (result)
+        for (const auto& info : result->images)
+            views.emplace(info.filePath, &info);
+
+    std::vector<ImageModel::ImgData> images(session.images.size());
+    for (size_t i = 0; i < session.images.size(); ++i)
+    {
+        images[i].checked = session.images[i].checked;
+        images[i].filePath = session.images[i].filePath;
+
+        const auto view = views.find(images[i].filePath);
+        if (view != views.end())
+            setDetectionResult(*view->second, images[i]);
+    }
+
+    calibrationWidget->graphicsView->scene()->clear();
+    imgModel->removeRows(0, imgModel->rowCount());
+    imgModel->addImages(images);
+    updateResults();
+}
+//------------------------------------------------------------------------------------------------
+std::map<std::string, std::string> CalibrationWidget::getSettings() const
+{
+    std::map<std::string, std::string> settings;
+    for (const QLineEdit* lineEdit : findChildren<QLineEdit*>())
+        if (!lineEdit->objectName().isEmpty())
+            settings[lineEdit->objectName().toStdString()] = lineEdit->text().toStdString();
+
+    for (const QComboBox* comboBox : findChildren<QComboBox*>())
+        if (!comboBox->objectName().isEmpty())
+            settings[comboBox->objectName().toStdString()]
+                = std::to_string(comboBox->currentIndex());
+
+    for (const QCheckBox* checkBox : findChildren<QCheckBox*>())
+        if (!checkBox->objectName().isEmpty())
+            settings[checkBox->objectName().toStdString()] = checkBox->isChecked() ? "1" : "0";
+
+    return settings;
+}
+//------------------------------------------------------------------------------------------------
+void CalibrationWidget::applySettings(const std::map<std::string, std::string>& settings)
+{
+    for (const auto& [name, value] : settings)
+    {
+        const QString objectName = QString::fromStdString(name);
+        if (QLineEdit* lineEdit = findChild<QLineEdit*>(objectName))
+            lineEdit->setText(QString::fromStdString(value));
+        else if (QComboBox* comboBox = findChild<QComboBox*>(objectName))
+            comboBox->setCurrentIndex(QString::fromStdString(value).toInt());
+        else if (QCheckBox* checkBox = findChild<QCheckBox*>(objectName))
+            checkBox->setChecked(value == "1");
+    }
+}
+//------------------------------------------------------------------------------------------------
 void CalibrationWidget::on_comboBox_ansicht_currentIndexChanged(int index)
 {
     const QModelIndex i = calibrationWidget->tableView_images->currentIndex();
@@ -541,15 +1034,18 @@ void CalibrationWidget::connectSignalsAndSlots()
         SIGNAL(currentRowChanged(const QModelIndex&, const QModelIndex&)), this,
         SLOT(showImage(const QModelIndex&)));
     connect(this, SIGNAL(calibrationDone(bool, QString)), this, SLOT(updateResults(bool, QString)));
-    connect(this, SIGNAL(calibrationDone(bool, QString)), this, SLOT(stopCalibration()));
+    connect(&calibrationWatcher, SIGNAL(finished()), this, SLOT(calibrationFinished()));
     connect(imgModel, SIGNAL(rowsRemoved(const QModelIndex&, int, int)), this->imgModel,
         SLOT(rowsRemoved(const QModelIndex&, int, int)));
+    connect(resultUpdateTimer, SIGNAL(timeout()), this, SLOT(flushPendingResults()));
+    connect(this, SIGNAL(filesFound(QStringList)), imgModel, SLOT(addImages(QStringList)));
+    connect(&scanWatcher, SIGNAL(finished()), this, SLOT(scanFinished()));
 }
 //------------------------------------------------------------------------------------------------
 void CalibrationWidget::closeEvent(QCloseEvent* event)
 {
     if (calibrationRunning)
-        stopCalibration();
+        waitForCalibration();
 }
 //-------------------------------------------------------------------------------------------------
 void CalibrationWidget::enableButtons()
@@ -558,6 +1054,8 @@ void CalibrationWidget::enableButtons()
     calibrationWidget->pushButton_ordnerHinzufuegen->setDisabled(false);
     calibrationWidget->pushButton_hinzufuegen->setDisabled(false);
     calibrationWidget->pushButton_kalibrierdatenLaden->setDisabled(false);
+    calibrationWidget->pushButton_sitzungLaden->setDisabled(false);
+    calibrationWidget->pushButton_sitzungSpeichern->setDisabled(false);
 }
 //-------------------------------------------------------------------------------------------------
 void CalibrationWidget::disableButtons()
@@ -566,6 +1064,8 @@ void CalibrationWidget::disableButtons()
     calibrationWidget->pushButton_ordnerHinzufuegen->setDisabled(true);
     calibrationWidget->pushButton_hinzufuegen->setDisabled(true);
     calibrationWidget->pushButton_kalibrierdatenLaden->setDisabled(true);
+    calibrationWidget->pushButton_sitzungLaden->setDisabled(true);
+    calibrationWidget->pushButton_sitzungSpeichern->setDisabled(true);
 }
 //-------------------------------------------------------------------------------------------------
 void CalibrationWidget::showError(const QString& msg)
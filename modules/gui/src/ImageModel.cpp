@@ -28,32 +28,64 @@ void ImageModel::changeItem(QStandardItem* item)
 
 void ImageModel::addImage(QString imgPath)
 {
-    ImgData imgData;
-    imgData.checked = true;
-    imgData.found = false;
-    imgData.filePath = imgPath.toStdString();
-    imgData.error = 0;
-    imageData.push_back(imgData);
-
-    setRowCount(rowCount() + 1);
-    QStandardItem* item = new QStandardItem(false);
-    item->setCheckable(true);
-    item->setCheckState(Qt::Checked);
-
-    setItem(rowCount() - 1, 0, item);
-    setItem(rowCount() - 1, 1, new QStandardItem(tr("Nein")));
-
-    item = new QStandardItem(QString::fromStdString(imgData.filePath));
-    item->setData(QVariant(imgPath));
-
-    setItem(rowCount() - 1, 2, item);
-    setItem(rowCount() - 1, 3, new QStandardItem("0"));
+    addImages(QStringList(imgPath));
+}
+
+void ImageModel::addImages(const QStringList& imgPaths)
+{
+    std::vector<ImgData> images(imgPaths.size());
+    for (int i = 0; i < imgPaths.size(); ++i)
+    {
+        images[i].checked = true;
+        images[i].filePath = imgPaths[i].toStdString();
+    }
+    addImages(images);
+}
+
+void ImageModel::addImages(const std::vector<ImgData>& images)
+{
+    const int firstRow = rowCount();
+
+    // all rows are added at once to notify the views only once
+    setRowCount(firstRow + static_cast<int>(images.size()));
+    for (size_t i = 0; i < images.size(); ++i)
+    {
+        const ImgData& imgData = images[i];
+        const int row = firstRow + static_cast<int>(i);
+        imageData.push_back(imgData);
+
+        QStandardItem* item = new QStandardItem(false);
+        item->setCheckable(true);
+        item->setCheckState(imgData.checked ? Qt::Checked : Qt::Unchecked);
+
+        setItem(row, 0, item);
+        setItem(row, 1, new QStandardItem(tr("Nein")));
+
+        const QString imgPath = QString::fromStdString(imgData.filePath);
+        item = new QStandardItem(imgPath);
+        item->setData(QVariant(imgPath));
+
+        setItem(row, 2, item);
+        setItem(row, 3, new QStandardItem("0"));
+        setItem(row, 4, new QStandardItem("0"));
+        setItem(row, 5, new QStandardItem("0"));
+        setItem(row, 6, new QStandardItem("0"));
+        setItem(row, 7, new QStandardItem("0"));
+        setItem(row, 8, new QStandardItem(""));
+        setItem(row, 9, new QStandardItem(""));
+
+        // images which were already processed show their results
+        if (imgData.detectionTime > 0 || !imgData.note.isEmpty())
+            updateRow(row, imgData);
+    }
 }
 
 void ImageModel::initHeader()
 {
     QStringList header;
-    header << tr("Nr.") << tr("Gefunden") << tr("Dateiname") << tr("Fehler");
+    header << tr("Nr.") << tr("Gefunden") << tr("Dateiname") << tr("Fehler") << tr("Ecken")
+           << tr("Zeit [ms]") << tr("Schärfe") << tr("Fehlbelichtet [%]")
+           << tr("Methode") << tr("Hinweis");
     setHorizontalHeaderLabels(header);
 }
 
@@ -76,13 +108,21 @@ void ImageModel::setImageData(int idx, ImgData data)
 void ImageModel::updateRow(int idx, const ImgData& data)
 {
     QString foundText = "";
-    if (data.found)
+    if (data.found && data.used)
         foundText = tr("Ja");
+    else if (data.found)
+        foundText = tr("Ja (nicht verwendet)");
     else
         foundText = tr("Nein");
 
     setItem(idx, 1, new QStandardItem(foundText));
     item(idx, 3)->setText(QString::fromStdString(std::to_string(data.error)));
+    item(idx, 4)->setText(QString::number(data.cornerCount));
+    item(idx, 5)->setText(QString::number(data.detectionTime, 'f', 1));
+    item(idx, 6)->setText(QString::number(data.sharpness, 'f', 1));
+    item(idx, 7)->setText(QString::number(data.clippedRatio * 100, 'f', 1));
+    item(idx, 8)->setText(data.method);
+    item(idx, 9)->setText(data.note);
 }
 
 void ImageModel::setCheckboxesEnabled(bool enabled)
@@ -93,5 +133,5 @@ void ImageModel::setCheckboxesEnabled(bool enabled)
 
 void ImageModel::rowsRemoved(const QModelIndex& parent, int start, int end)
 {
-    imageData.erase(imageData.begin() + start);
+    imageData.erase(imageData.begin() + start, imageData.begin() + end + 1);
 }